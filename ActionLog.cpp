@@ -0,0 +1,187 @@
+
+#include "ActionLog.hpp"
+
+#include <string.h>
+#include <iostream>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+using namespace std;
+
+
+
+ActionLog::Record ActionLog::_ring[ActionLog::Capacity];
+boost::atomic<uint32_t> ActionLog::_head(0);
+boost::atomic<uint32_t> ActionLog::_tail(0);
+boost::atomic<uint32_t> ActionLog::_dropped(0);
+
+//	everything logs at Info to start with, which is what the old STP_DEBUG prints showed
+boost::atomic<uint32_t> ActionLog::_levels(Info | (Info << 8) | (Info << 16));
+
+map<string, ActionLog::Level> ActionLog::_overrides;
+boost::atomic<bool> ActionLog::_hasOverrides(false);
+boost::mutex ActionLog::_overridesMutex;
+
+boost::atomic<ostream *> ActionLog::_out(&clog);
+boost::thread *ActionLog::_writer = NULL;
+boost::atomic<bool> ActionLog::_running(false);
+
+
+static const char *LevelNames[] = { "OFF", "ERROR", "INFO", "DEBUG" };
+
+//	how long the writer sleeps when the ring is empty
+static const int WriterIdleMs = 20;
+
+
+
+//	starts the writer before gameplay runs, and makes sure everything gets written before the
+//	program exits
+class ActionLogStarter {
+public:
+	ActionLogStarter() {
+		ActionLog::start();
+	}
+
+	~ActionLogStarter() {
+		ActionLog::stop();
+	}
+};
+
+static ActionLogStarter starter;
+
+
+
+bool ActionLog::enabled(const string &actionName, ActionAbstractionLevel absLevel, Level level) {
+	int current = (_levels.load(boost::memory_order_relaxed) >> (8 * absLevel)) & 0xff;
+
+	//	if someone's changing the overrides right now, just use the default for this time
+	if ( _hasOverrides.load(boost::memory_order_relaxed) ) {
+		boost::mutex::scoped_try_lock lock(_overridesMutex);
+		if ( lock.owns_lock() ) {
+			map<string, Level>::const_iterator itr = _overrides.find(actionName);
+			if ( itr != _overrides.end() ) current = itr->second;
+		}
+	}
+
+	return level != Off && level <= current;
+}
+
+
+
+void ActionLog::record(Level level, Event event, uint64_t timestamp, const string &action, const char *detail, int arg) {
+	uint32_t head = _head.load(boost::memory_order_relaxed);
+	if ( head - _tail.load(boost::memory_order_acquire) >= Capacity ) {
+		_dropped.fetch_add(1, boost::memory_order_relaxed);
+		return;
+	}
+
+	Record &r = _ring[head % Capacity];
+	r.timestamp = timestamp;
+	r.event = event;
+	r.level = level;
+	strncpy(r.action, action.c_str(), sizeof(r.action) - 1);
+	r.action[sizeof(r.action) - 1] = '\0';
+	strncpy(r.detail, detail, sizeof(r.detail) - 1);
+	r.detail[sizeof(r.detail) - 1] = '\0';
+	r.arg = arg;
+
+	_head.store(head + 1, boost::memory_order_release);
+}
+
+
+
+void ActionLog::setLevel(ActionAbstractionLevel absLevel, Level level) {
+	uint32_t shift = 8 * absLevel;
+	uint32_t levels = _levels.load(boost::memory_order_relaxed);
+	uint32_t updated;
+	do {
+		updated = (levels & ~(0xffu << shift)) | ((uint32_t)level << shift);
+	} while ( !_levels.compare_exchange_weak(levels, updated, boost::memory_order_relaxed) );
+}
+
+
+
+void ActionLog::setLevel(const string &actionName, Level level) {
+	boost::mutex::scoped_lock lock(_overridesMutex);
+	_overrides[actionName] = level;
+	_hasOverrides.store(true, boost::memory_order_relaxed);
+}
+
+
+
+void ActionLog::clearLevel(const string &actionName) {
+	boost::mutex::scoped_lock lock(_overridesMutex);
+	_overrides.erase(actionName);
+	_hasOverrides.store(!_overrides.empty(), boost::memory_order_relaxed);
+}
+
+
+
+void ActionLog::setOutput(ostream *out) {
+	_out.store(out, boost::memory_order_release);
+}
+
+
+
+void ActionLog::start() {
+	if ( _writer ) return;
+
+	_running.store(true, boost::memory_order_release);
+	_writer = new boost::thread(&ActionLog::run);
+}
+
+
+
+void ActionLog::stop() {
+	if ( !_writer ) return;
+
+	_running.store(false, boost::memory_order_release);
+	_writer->join();
+	delete _writer;
+	_writer = NULL;
+}
+
+
+
+void ActionLog::run() {
+	while ( _running.load(boost::memory_order_acquire) ) {
+		if ( !drain() ) boost::this_thread::sleep(boost::posix_time::milliseconds(WriterIdleMs));
+	}
+
+	//	anything recorded before stop() still gets written
+	drain();
+}
+
+
+
+//	writes everything in the ring.  returns false if it was empty.
+bool ActionLog::drain() {
+	uint32_t tail = _tail.load(boost::memory_order_relaxed);
+	uint32_t head = _head.load(boost::memory_order_acquire);
+	if ( tail == head ) return false;
+
+	ostream &out = *_out.load(boost::memory_order_acquire);
+	for ( ; tail != head; tail++ ) {
+		write(_ring[tail % Capacity], out);
+		_tail.store(tail + 1, boost::memory_order_release);
+	}
+	out.flush();
+
+	return true;
+}
+
+
+
+void ActionLog::write(const Record &r, ostream &out) {
+	out << r.timestamp << " " << LevelNames[r.level] << " " << r.action << ": ";
+
+	switch ( r.event ) {
+		case SyncPointReached:
+			out << "transitioned sync pt '" << r.detail << "'";
+			break;
+		case PlayFailed:
+			out << "failed in sequence " << r.arg;
+			break;
+	}
+
+	out << "\n";
+}
@@ -0,0 +1,106 @@
+
+#pragma once
+
+#include "STP.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <ostream>
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+
+
+
+/**
+ *	Structured log for Actions that never blocks or flushes on the gameplay thread.
+ *
+ *	record() copies a fixed-size Record into a single-producer/single-consumer ring and returns.
+ *	A background thread drains the ring, formats the records, and writes them to the output
+ *	stream.  If the writer falls behind and the ring is full, records are dropped and counted.
+ *	The writer is started by a static initializer, so the gameplay thread never creates it.
+ *
+ *	Levels can be set for all Skills, Tactics, or Plays, and overridden per Action name.  They
+ *	may be changed from any thread.
+ *
+ *	Only the gameplay thread may call record().
+ */
+class ActionLog {
+public:
+	typedef enum {
+		Off = 0,
+		Error = 1,
+		Info = 2,
+		Debug = 3
+	} Level;
+
+	typedef enum {
+		SyncPointReached,
+		PlayFailed
+	} Event;
+
+
+	///	what goes through the ring.  Strings are truncated to fit.
+	struct Record {
+		uint64_t timestamp;
+		Event event;
+		Level level;
+		char action[32];
+		char detail[32];
+		int arg;
+	};
+
+	static const int Capacity = 1024;
+
+
+	///	true if an Action named @actionName at @absLevel is logging at @level
+	static bool enabled(const std::string &actionName, ActionAbstractionLevel absLevel, Level level);
+
+	static void record(Level level, Event event, uint64_t timestamp, const std::string &action, const char *detail, int arg = 0);
+
+
+	static void setLevel(ActionAbstractionLevel absLevel, Level level);
+
+	///	overrides the level for every Action with this name
+	static void setLevel(const std::string &actionName, Level level);
+	static void clearLevel(const std::string &actionName);
+
+
+	///	where the writer thread sends its output, std::clog by default.  Takes effect from the
+	///	writer's next batch of records.
+	static void setOutput(std::ostream *out);
+
+	///	drains what's left and stops the writer thread.  Called automatically at exit.
+	static void stop();
+
+	///	records dropped because the ring was full
+	static uint32_t dropped() {
+		return _dropped.load(boost::memory_order_relaxed);
+	}
+
+
+private:
+	friend class ActionLogStarter;
+
+	static void start();
+	static void run();
+	static bool drain();
+	static void write(const Record &r, std::ostream &out);
+
+	static Record _ring[Capacity];
+	static boost::atomic<uint32_t> _head;	//	next slot the producer writes
+	static boost::atomic<uint32_t> _tail;	//	next slot the writer reads
+	static boost::atomic<uint32_t> _dropped;
+
+	//	one byte per ActionAbstractionLevel
+	static boost::atomic<uint32_t> _levels;
+
+	//	per-name overrides, only looked at if the lock is free
+	static std::map<std::string, Level> _overrides;
+	static boost::atomic<bool> _hasOverrides;
+	static boost::mutex _overridesMutex;
+
+	static boost::atomic<std::ostream *> _out;
+	static boost::thread *_writer;
+	static boost::atomic<bool> _running;
+};
@@ -0,0 +1,177 @@
+
+#include "CommandBuffer.hpp"
+
+#include <framework/SystemState.hpp>
+
+#include <string>
+
+using namespace std;
+using namespace Geometry2d;
+
+
+
+CommandBuffer::Slot CommandBuffer::_slots[WorldSnapshot::MaxRobots];
+int CommandBuffer::_writes = 0;
+int CommandBuffer::_applied = 0;
+int CommandBuffer::_moves = 0;
+int CommandBuffer::_replans = 0;
+float CommandBuffer::_replanRate = 0;
+
+
+
+void RobotCommands::apply(OurRobot *robot) const {
+	if ( _written & AvoidOpponents ) robot->avoidOpponents(_avoidOpponents);
+	if ( _written & AvoidBall ) robot->avoidBall(_avoidBall);
+
+	if ( _written & Motion ) {
+		switch ( _motion ) {
+			case MotionMove:
+				robot->move(_motionTarget, _stopAtEnd);
+				break;
+			case MotionVelocity:
+				robot->worldVelocity(_motionTarget);
+				break;
+			case MotionStop:
+				robot->stop();
+				break;
+		}
+	}
+
+	if ( _written & Rotation ) {
+		switch ( _rotation ) {
+			case RotationFace:
+				robot->face(_faceTarget, _faceContinuous);
+				break;
+			case RotationVelocity:
+				robot->angularVelocity(_angularVelocity);
+				break;
+			case RotationNone:
+				robot->faceNone();
+				break;
+		}
+	}
+
+	if ( _written & Scale ) {
+		robot->setWScale(_wScale);
+		robot->setVScale(_vScale);
+	}
+
+	if ( _written & Dribble ) robot->dribble(_dribble);
+
+	if ( _written & Shot ) {
+		if ( _chip ) {
+			robot->chip(_shotStrength);
+		} else {
+			robot->kick(_shotStrength);
+		}
+	}
+}
+
+
+
+void RobotCommands::record(RobotCommandRecord &out) const {
+	out.written = _written;
+	out.motion = (RobotCommandRecord::MotionKind)_motion;
+	out.x = _motionTarget.x;
+	out.y = _motionTarget.y;
+	out.stopAtEnd = _stopAtEnd;
+	out.rotation = (RobotCommandRecord::RotationKind)_rotation;
+	out.faceX = _faceTarget.x;
+	out.faceY = _faceTarget.y;
+	out.faceContinuous = _faceContinuous;
+	out.angularVelocity = _angularVelocity;
+	out.avoidOpponents = _avoidOpponents;
+	out.avoidBall = _avoidBall;
+	out.dribble = _dribble;
+	out.chip = _chip;
+	out.shotStrength = _shotStrength;
+	out.wScale = _wScale;
+	out.vScale = _vScale;
+}
+
+
+
+CommandBuffer::Slot *CommandBuffer::slotFor(OurRobot *robot) {
+	Slot *empty = NULL;
+	for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+		if ( _slots[i].robot == robot ) return &_slots[i];
+		if ( !empty && !_slots[i].robot ) empty = &_slots[i];
+	}
+
+	return empty;
+}
+
+
+
+RobotCommands &CommandBuffer::forRobot(OurRobot *robot) {
+	if ( !robot ) throw string("ERROR: CommandBuffer::forRobot() called with a NULL robot.");
+
+	Slot *slot = slotFor(robot);
+	if ( !slot ) throw string("ERROR: CommandBuffer is out of robot slots.");
+
+	if ( !slot->robot ) {
+		slot->robot = robot;
+	}
+
+	return slot->pending;
+}
+
+
+
+void CommandBuffer::flush(SystemState *state) {
+	_writes = 0;
+	_applied = 0;
+
+	CommandFrame &frame = CommandHandoff::back();
+	frame.timestamp = state->timestamp;
+	frame.count = 0;
+
+	int moves = 0;
+	int replans = 0;
+
+	for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+		Slot &slot = _slots[i];
+		if ( !slot.robot ) continue;
+
+		RobotCommands &now = slot.pending;
+		const RobotCommands &last = slot.last;
+
+		//	keep last frame's goal if the new one is close enough to it
+		if ( (now._written & RobotCommands::Motion) && now._motion == RobotCommands::MotionMove ) {
+			moves++;
+
+			bool keepGoal = (last._written & RobotCommands::Motion) &&
+					last._motion == RobotCommands::MotionMove &&
+					last._stopAtEnd == now._stopAtEnd &&
+					now._motionTarget.distTo(last._motionTarget) <= now._moveTolerance;
+
+			if ( keepGoal ) {
+				now._motionTarget = last._motionTarget;
+			} else {
+				replans++;
+			}
+		}
+
+		now.apply(slot.robot);
+
+		if ( now._written ) {
+			RobotCommandRecord &out = frame.robots[frame.count++];
+			out.shell = slot.robot->shell();
+			now.record(out);
+		}
+
+		_writes += now._writes;
+		for ( uint32_t kinds = now._written; kinds; kinds &= kinds - 1 ) _applied++;
+
+		slot.last = now;
+		slot.pending.clear();
+	}
+
+	CommandHandoff::publish();
+
+	_moves += moves;
+	_replans += replans;
+	if ( moves > 0 ) {
+		_replanRate += ((float)replans / moves - _replanRate) / ReplanRateFrames;
+	}
+}
@@ -0,0 +1,274 @@
+
+#pragma once
+
+#include "World/WorldSnapshot.hpp"
+#include "CommandHandoff.hpp"
+
+#include <Geometry2d/Point.hpp>
+
+#include <stdint.h>
+
+
+class OurRobot;
+class SystemState;
+
+
+
+///	One robot's commands for this frame, with the same calls as OurRobot.  Each kind of command
+///	keeps only the last value written, and nothing reaches the robot until CommandBuffer::flush().
+class RobotCommands {
+public:
+	///	bits for the kinds of command, as in written()
+	enum {
+		Motion = 1,
+		Rotation = 2,
+		AvoidOpponents = 4,
+		AvoidBall = 8,
+		Dribble = 16,
+		Shot = 32,
+		Scale = 64
+	};
+
+
+	RobotCommands() {
+		clear();
+	}
+
+
+	//	motion - move, worldVelocity and stop replace each other
+	void move(const Geometry2d::Point &pt, bool stopAtEnd = false) {
+		moveWithin(pt, 0, stopAtEnd);
+	}
+
+	///	Moves to anywhere within @tolerance of @pt.  If the robot is already heading for a point
+	///	that close, it keeps that goal instead of planning a new path.
+	void moveWithin(const Geometry2d::Point &pt, float tolerance, bool stopAtEnd = false) {
+		_motion = MotionMove;
+		_motionTarget = pt;
+		_moveTolerance = tolerance;
+		_stopAtEnd = stopAtEnd;
+		write(Motion);
+	}
+
+	void worldVelocity(const Geometry2d::Point &v) {
+		_motion = MotionVelocity;
+		_motionTarget = v;
+		write(Motion);
+	}
+
+	void stop() {
+		_motion = MotionStop;
+		write(Motion);
+	}
+
+
+	//	rotation - face, faceNone and angularVelocity replace each other
+	void face(const Geometry2d::Point &pt, bool continuous = false) {
+		_rotation = RotationFace;
+		_faceTarget = pt;
+		_faceContinuous = continuous;
+		write(Rotation);
+	}
+
+	void faceNone() {
+		_rotation = RotationNone;
+		write(Rotation);
+	}
+
+	void angularVelocity(float w) {
+		_rotation = RotationVelocity;
+		_angularVelocity = w;
+		write(Rotation);
+	}
+
+
+	void avoidOpponents(bool avoid) {
+		_avoidOpponents = avoid;
+		write(AvoidOpponents);
+	}
+
+	void avoidBall(float radius) {
+		_avoidBall = radius;
+		write(AvoidBall);
+	}
+
+	void dribble(uint8_t speed) {
+		_dribble = speed;
+		write(Dribble);
+	}
+
+
+	//	kick and chip replace each other
+	void kick(uint8_t strength) {
+		_chip = false;
+		_shotStrength = strength;
+		write(Shot);
+	}
+
+	void chip(uint8_t strength) {
+		_chip = true;
+		_shotStrength = strength;
+		write(Shot);
+	}
+
+
+	void setWScale(float scale) {
+		_wScale = scale;
+		write(Scale);
+	}
+
+	void setVScale(float scale) {
+		_vScale = scale;
+		write(Scale);
+	}
+
+
+	///	kinds of command written this frame
+	uint32_t written() const {
+		return _written;
+	}
+
+	///	calls to the setters this frame, including ones that were overwritten
+	int writes() const {
+		return _writes;
+	}
+
+
+private:
+	friend class CommandBuffer;
+
+	//	same values as RobotCommandRecord's MotionKind and RotationKind
+	enum {
+		MotionMove,
+		MotionVelocity,
+		MotionStop
+	};
+
+	enum {
+		RotationNone,
+		RotationFace,
+		RotationVelocity
+	};
+
+
+	void write(uint32_t kind) {
+		_written |= kind;
+		_writes++;
+	}
+
+	void clear() {
+		_written = 0;
+		_writes = 0;
+		_motion = MotionStop;
+		_moveTolerance = 0;
+		_stopAtEnd = false;
+		_rotation = RotationNone;
+		_faceContinuous = false;
+		_angularVelocity = 0;
+		_avoidOpponents = false;
+		_avoidBall = 0;
+		_dribble = 0;
+		_chip = false;
+		_shotStrength = 0;
+		_wScale = 1;
+		_vScale = 1;
+	}
+
+	///	sends the commands written this frame to @robot
+	void apply(OurRobot *robot) const;
+
+	///	copies the commands into the form the radio reads
+	void record(RobotCommandRecord &out) const;
+
+
+	uint32_t _written;
+	int _writes;
+
+	int _motion;
+	Geometry2d::Point _motionTarget;
+	float _moveTolerance;
+	bool _stopAtEnd;
+
+	int _rotation;
+	Geometry2d::Point _faceTarget;
+	bool _faceContinuous;
+	float _angularVelocity;
+
+	bool _avoidOpponents;
+	float _avoidBall;
+	uint8_t _dribble;
+	bool _chip;
+	uint8_t _shotStrength;
+	float _wScale;
+	float _vScale;
+};
+
+
+
+/**
+ *	Per-robot command buffers for the frame.
+ *
+ *	Actions write their robot's commands into forRobot(), usually through
+ *	SingleRobotAction::commands(), as many times as they like.  flush() is called once at the
+ *	end of the frame and sends each robot one call per kind of command, with the last value
+ *	written.  Every command written in the frame is sent, even if it's the same as last frame's:
+ *	OurRobot rebuilds its commands from scratch each tick, so one that isn't sent is dropped.
+ *
+ *	A move whose target is within its tolerance of the goal the robot was sent last frame is
+ *	sent that same goal again, so the path planner doesn't replan for millimeters of jitter.
+ *
+ *	Each flush also publishes the frame's commands to the radio through the CommandHandoff.
+ */
+class CommandBuffer {
+public:
+	static RobotCommands &forRobot(OurRobot *robot);
+
+	///	sends every robot its net commands, publishes them to the CommandHandoff, and empties the buffers
+	static void flush(SystemState *state);
+
+
+	///	setter calls in the last flushed frame, and the commands that reached robots
+	static int writes() {
+		return _writes;
+	}
+
+	static int applied() {
+		return _applied;
+	}
+
+
+	///	move commands flushed since the program started, and how many of them sent the robot a
+	///	new goal (a replan) instead of keeping the previous one
+	static int moves() {
+		return _moves;
+	}
+
+	static int replans() {
+		return _replans;
+	}
+
+	///	recent fraction of move commands that were replans, smoothed over about ReplanRateFrames frames
+	static float replanRate() {
+		return _replanRate;
+	}
+
+	static const int ReplanRateFrames = 60;
+
+
+private:
+	struct Slot {
+		OurRobot *robot;
+		RobotCommands pending;
+		RobotCommands last;
+	};
+
+	static Slot *slotFor(OurRobot *robot);
+
+	static Slot _slots[WorldSnapshot::MaxRobots];
+	static int _writes;
+	static int _applied;
+
+	static int _moves;
+	static int _replans;
+	static float _replanRate;
+};
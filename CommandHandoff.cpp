@@ -0,0 +1,42 @@
+
+#include "CommandHandoff.hpp"
+
+
+
+CommandFrame CommandHandoff::_frames[3];
+
+uint32_t CommandHandoff::_back = 0;
+uint32_t CommandHandoff::_front = 1;
+boost::atomic<uint32_t> CommandHandoff::_middle(2);
+
+uint64_t CommandHandoff::_generation = 0;
+boost::atomic<uint64_t> CommandHandoff::_published(0);
+boost::atomic<uint64_t> CommandHandoff::_dropped(0);
+boost::atomic<uint64_t> CommandHandoff::_stale(0);
+
+
+
+void CommandHandoff::publish() {
+	_frames[_back].generation = ++_generation;
+
+	//	release so the consumer sees the whole frame once it sees the index
+	uint32_t previous = _middle.exchange(_back | Fresh, boost::memory_order_acq_rel);
+	if ( previous & Fresh ) _dropped.fetch_add(1, boost::memory_order_relaxed);
+	_back = previous & ~Fresh;
+
+	_published.fetch_add(1, boost::memory_order_relaxed);
+}
+
+
+
+const CommandFrame *CommandHandoff::latest() {
+	if ( _middle.load(boost::memory_order_relaxed) & Fresh ) {
+		uint32_t previous = _middle.exchange(_front, boost::memory_order_acq_rel);
+		_front = previous & ~Fresh;
+	} else {
+		_stale.fetch_add(1, boost::memory_order_relaxed);
+	}
+
+	const CommandFrame &frame = _frames[_front];
+	return frame.generation ? &frame : NULL;
+}
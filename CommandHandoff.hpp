@@ -0,0 +1,127 @@
+
+#pragma once
+
+#include "World/WorldSnapshot.hpp"
+
+#include <stdint.h>
+#include <boost/atomic.hpp>
+
+
+
+///	one robot's net commands for a frame, in the form the radio side reads them
+struct RobotCommandRecord {
+	typedef enum {
+		MotionMove,
+		MotionVelocity,
+		MotionStop
+	} MotionKind;
+
+	typedef enum {
+		RotationNone,
+		RotationFace,
+		RotationVelocity
+	} RotationKind;
+
+	int shell;
+
+	///	RobotCommands kinds that were written this frame.  The others hold defaults.
+	uint32_t written;
+
+	MotionKind motion;
+	float x, y;		//	goal for MotionMove, velocity for MotionVelocity
+	bool stopAtEnd;
+
+	RotationKind rotation;
+	float faceX, faceY;
+	bool faceContinuous;
+	float angularVelocity;
+
+	bool avoidOpponents;
+	float avoidBall;
+	uint8_t dribble;
+	bool chip;
+	uint8_t shotStrength;
+	float wScale;
+	float vScale;
+};
+
+
+
+///	every robot's commands from one gameplay tick
+struct CommandFrame {
+	///	1 for the first frame published, then counting up.  0 means nothing was published yet.
+	uint64_t generation;
+
+	///	SystemState::timestamp of the tick that produced it
+	uint64_t timestamp;
+
+	int count;
+	RobotCommandRecord robots[WorldSnapshot::MaxRobots];
+};
+
+
+
+/**
+ *	Hands CommandFrames from the gameplay thread to the radio thread without either one waiting.
+ *
+ *	This is a triple buffer: gameplay fills a back frame and swaps it with the middle one, and the
+ *	radio swaps the middle one with its front frame when a newer one is there.  Both swaps are a
+ *	single atomic exchange.  The radio always gets the newest complete frame; if gameplay publishes
+ *	twice before the radio looks, the older one is dropped, and if the radio looks again before
+ *	gameplay publishes, it gets the same frame back as stale.
+ *
+ *	There must be exactly one producer thread and one consumer thread.
+ *
+ *	The producer is CommandBuffer::flush(), once per gameplay tick.  The consumer is the radio
+ *	thread, which lives in the framework outside this tree: each transmit cycle it should call
+ *	latest() and build its packets from the CommandFrame's RobotCommandRecords, keyed by shell.
+ *	Until it does, gameplay still drives the robots synchronously through OurRobot in flush(),
+ *	and the published frames simply go unread.
+ */
+class CommandHandoff {
+public:
+	///	Producer: the frame to fill for this tick.  It's not cleared, so set everything.
+	static CommandFrame &back() {
+		return _frames[_back];
+	}
+
+	///	Producer: makes back() the newest frame and gives the producer a new back frame.
+	static void publish();
+
+
+	///	Consumer: the newest complete frame, or NULL if there hasn't been one yet.
+	///	The frame stays valid until the next call.
+	static const CommandFrame *latest();
+
+
+	///	frames published by gameplay
+	static uint64_t published() {
+		return _published.load(boost::memory_order_relaxed);
+	}
+
+	///	published frames that were replaced before the radio took them
+	static uint64_t dropped() {
+		return _dropped.load(boost::memory_order_relaxed);
+	}
+
+	///	radio reads that found nothing newer than what they had
+	static uint64_t stale() {
+		return _stale.load(boost::memory_order_relaxed);
+	}
+
+
+private:
+	///	set in _middle when it holds a frame the consumer hasn't taken yet
+	static const uint32_t Fresh = 4;
+
+	static CommandFrame _frames[3];
+
+	static uint32_t _back;		//	producer only
+	static uint32_t _front;		//	consumer only
+	static boost::atomic<uint32_t> _middle;
+
+	static uint64_t _generation;	//	producer only
+	static boost::atomic<uint64_t> _published;
+	static boost::atomic<uint64_t> _dropped;
+	static boost::atomic<uint64_t> _stale;
+};
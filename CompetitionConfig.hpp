@@ -0,0 +1,43 @@
+
+//	Generated by tools/gen_competition_config.py - do not edit.
+
+#pragma once
+
+#include <Constants.hpp>
+
+
+namespace CompetitionConfig {
+
+	namespace Bump {
+		static const float AccelBias = 0.1f;
+		static const float BumpCompleteDistance = 0.5f;
+		static const float ChargeThresh = 0.1f;
+		static const float DriveAroundDist = 0.45f;
+		static const float EscapeChargeThresh = 0.1f;
+		static const bool FaceBallOtherwiseTarget = true;
+		static const float FacingThreshDeg = 10.0f;
+		static const float SetupBallAvoid = 1.0f;
+	}
+
+	namespace Fullback {
+		static const float DefendGoalRadius = 0.9f;
+		static const float InterceptMinBallSpeed = 0.5f;
+		static const float MoveTolerance = 0.03f;
+		static const float OpponentAvoidHysteresis = 0.2f;
+		static const float OpponentAvoidThreshold = 2.0f;
+	}
+
+	namespace LineKick {
+		static const float AccelBias = 0.1f;
+		static const float BallProjectTime = 0.4f;
+		static const float ChargeThresh = 0.1f;
+		static const float DoneStateThresh = 0.11f;
+		static const float DriveAroundDist = 0.25f;
+		static const float EscapeChargeThresh = 0.1f;
+		static const float FacingThreshDeg = 10.0f;
+		static const float MaxChargeSpeed = 1.5f;
+		static const float SetupBallAvoid = (float)(Ball_Radius * 2.0);
+		static const float SetupMoveTolerance = 0.02f;
+	}
+
+}
@@ -0,0 +1,26 @@
+
+#include "ConfigSnapshot.hpp"
+
+#include <boost/foreach.hpp>
+
+using namespace std;
+
+
+
+uint32_t ConfigSnapshotBase::_publishCount = 0;
+
+
+
+vector<ConfigSnapshotBase *> &ConfigSnapshotBase::registry() {
+	//	function-local so snapshots constructed during static initialization can register
+	static vector<ConfigSnapshotBase *> snapshots;
+	return snapshots;
+}
+
+
+
+void ConfigSnapshotBase::refreshAll() {
+	BOOST_FOREACH(ConfigSnapshotBase *snapshot, registry()) {
+		snapshot->refresh();
+	}
+}
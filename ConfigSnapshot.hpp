@@ -0,0 +1,102 @@
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+
+///	type-independent part of ConfigSnapshot, so every snapshot can be refreshed from one place
+class ConfigSnapshotBase {
+public:
+	virtual ~ConfigSnapshotBase() {}
+
+	///	Re-reads the Config values behind every snapshot and keeps the ones that changed.
+	///	Called once per frame, before any Actions update, from the thread that runs gameplay.
+	static void refreshAll();
+
+	///	number of times refresh() has found a changed value, across all snapshots
+	static uint32_t publishCount() {
+		return _publishCount;
+	}
+
+
+protected:
+	ConfigSnapshotBase() {
+		registry().push_back(this);
+	}
+
+	virtual void refresh() = 0;
+
+	static uint32_t _publishCount;
+
+
+private:
+	static std::vector<ConfigSnapshotBase *> &registry();
+};
+
+
+
+/**
+ *	A per-frame copy of a class's tunables.
+ *
+ *	@T must be a POD struct.  Each frame refreshAll() fills a zeroed T with @load and keeps it if
+ *	it differs from the current one, so Actions pay for a copy of the struct instead of a
+ *	ConfigDouble dereference per field, and every Action in a frame sees the same values even
+ *	if one is edited halfway through the frame.  The first read() loads the values itself if no
+ *	frame has refreshed them yet.
+ *
+ *	note: this doesn't guard against races with the UI, so it doesn't make config edits
+ *	thread-safe.  The UI still writes the ConfigDoubles directly and Configuration has no change
+ *	hook to publish from, so the reads in @load race with edits just as the old per-field reads
+ *	did - they just happen once per frame in one place.
+ *	The snapshot itself is only touched on the gameplay thread.
+ *
+ *	Declare one as a static member next to the ConfigDoubles it reads, and call read() once at
+ *	the top of update().
+ *
+ *	Builds with STP_COMPETITION defined don't use snapshots: the classes' params() accessors return
+ *	constants from CompetitionConfig.hpp instead, generated by tools/gen_competition_config.py.
+ */
+template<class T>
+class ConfigSnapshot : public ConfigSnapshotBase {
+public:
+	typedef void (*Loader)(T &out);
+
+	ConfigSnapshot(Loader load) : _load(load), _version(0) {
+		memset(&_value, 0, sizeof(T));
+	}
+
+
+	///	this frame's values.  If refreshAll() hasn't run yet, they're loaded now, so Actions
+	///	made before the first frame don't see zeros.
+	const T &read() {
+		if ( _version == 0 ) refresh();
+		return _value;
+	}
+
+	///	incremented every time the values change
+	uint32_t version() const {
+		return _version;
+	}
+
+
+protected:
+	virtual void refresh() {
+		T next;
+		memset(&next, 0, sizeof(T));
+		_load(next);
+
+		if ( _version == 0 || memcmp(&next, &_value, sizeof(T)) != 0 ) {
+			memcpy(&_value, &next, sizeof(T));
+			_version++;
+			_publishCount++;
+		}
+	}
+
+
+private:
+	Loader _load;
+	uint32_t _version;
+	T _value;
+};
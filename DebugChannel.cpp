@@ -0,0 +1,40 @@
+
+#include "DebugChannel.hpp"
+
+#include <framework/SystemState.hpp>
+
+
+
+DebugChannel::Entry DebugChannel::_entries[DebugChannel::Capacity];
+int DebugChannel::_first = 0;
+int DebugChannel::_count = 0;
+int DebugChannel::_dropped = 0;
+//	competition runs have no viewer unless the framework says otherwise
+#ifdef STP_COMPETITION
+bool DebugChannel::_viewerAttached = false;
+#else
+bool DebugChannel::_viewerAttached = true;
+#endif
+
+
+
+void DebugChannel::flush(SystemState *state) {
+	if ( _viewerAttached ) {
+		for ( int i = 0; i < _count; i++ ) {
+			const Entry &e = _entries[(_first + i) % Capacity];
+
+			if ( e.kind == Text ) {
+				if ( !e.robot ) continue;
+
+				QString text(e.format);
+				for ( int a = 0; a < e.argCount; a++ ) text = text.arg(e.args[a]);
+				e.robot->addText(text);
+			} else {
+				state->drawLine(Geometry2d::Point(e.x0, e.y0), Geometry2d::Point(e.x1, e.y1), QColor::fromRgba(e.color));
+			}
+		}
+	}
+
+	_first = 0;
+	_count = 0;
+}
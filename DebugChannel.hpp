@@ -0,0 +1,155 @@
+
+#pragma once
+
+#include <Geometry2d/Point.hpp>
+#include <Geometry2d/Segment.hpp>
+
+#include <stdint.h>
+
+
+class OurRobot;
+class SystemState;
+
+
+///	Set STP_DEBUG_DRAW to 0 to compile all DebugChannel calls away.  Competition builds default to off.
+#ifndef STP_DEBUG_DRAW
+#ifdef STP_COMPETITION
+#define STP_DEBUG_DRAW 0
+#else
+#define STP_DEBUG_DRAW 1
+#endif
+#endif
+
+
+
+/**
+ *	Debug text and lines recorded as plain structs during a frame, instead of being formatted
+ *	and handed to the robot or SystemState as they happen.
+ *
+ *	Text entries keep a pointer to their format string (which must be a literal) and up to two
+ *	float arguments.  flush() turns the frame's entries into QStrings and drawn lines, but only
+ *	if a viewer is attached; otherwise it just throws them away.  The entries live in a fixed
+ *	ring, so recording never allocates, and when a frame overflows it the oldest are dropped.
+ */
+class DebugChannel {
+public:
+	static const int Capacity = 256;
+
+	///	colors are 0xAARRGGBB
+	static const uint32_t White = 0xffffffff;
+	static const uint32_t Black = 0xff000000;
+
+	static uint32_t rgb(int r, int g, int b) {
+		return 0xff000000 | (r << 16) | (g << 8) | b;
+	}
+
+
+	///	adds a line of text to @robot's status, with %1 and %2 in @format replaced by the arguments
+	static void text(OurRobot *robot, const char *format) {
+#if STP_DEBUG_DRAW
+		add(robot, format, 0, 0, 0);
+#endif
+	}
+
+	static void text(OurRobot *robot, const char *format, float arg) {
+#if STP_DEBUG_DRAW
+		add(robot, format, 1, arg, 0);
+#endif
+	}
+
+	static void text(OurRobot *robot, const char *format, float arg1, float arg2) {
+#if STP_DEBUG_DRAW
+		add(robot, format, 2, arg1, arg2);
+#endif
+	}
+
+
+	static void line(const Geometry2d::Point &p0, const Geometry2d::Point &p1, uint32_t color = Black) {
+#if STP_DEBUG_DRAW
+		Entry &e = next();
+		e.kind = Line;
+		e.x0 = p0.x;
+		e.y0 = p0.y;
+		e.x1 = p1.x;
+		e.y1 = p1.y;
+		e.color = color;
+#endif
+	}
+
+	static void line(const Geometry2d::Segment &seg, uint32_t color = Black) {
+		line(seg.pt[0], seg.pt[1], color);
+	}
+
+
+	///	Formats and hands off everything recorded since the last flush, then empties the channel.
+	///	Called once at the end of each frame.
+	static void flush(SystemState *state);
+
+
+	///	whether anything will look at the output.  Off by default in STP_COMPETITION builds, on otherwise;
+	///	the framework should call setViewerAttached() when a viewer connects or goes away.
+	static bool viewerAttached() {
+		return _viewerAttached;
+	}
+
+	static void setViewerAttached(bool attached) {
+		_viewerAttached = attached;
+	}
+
+
+	///	entries lost to overflow since the program started
+	static int dropped() {
+		return _dropped;
+	}
+
+
+private:
+	enum Kind {
+		Text,
+		Line
+	};
+
+	struct Entry {
+		Kind kind;
+
+		//	Text
+		OurRobot *robot;
+		const char *format;
+		int argCount;
+		float args[2];
+
+		//	Line
+		float x0, y0, x1, y1;
+		uint32_t color;
+	};
+
+
+	static Entry &next() {
+		if ( _count == Capacity ) {
+			_first = (_first + 1) % Capacity;
+			_count--;
+			_dropped++;
+		}
+
+		Entry &e = _entries[(_first + _count) % Capacity];
+		_count++;
+		return e;
+	}
+
+	static void add(OurRobot *robot, const char *format, int argCount, float arg1, float arg2) {
+		Entry &e = next();
+		e.kind = Text;
+		e.robot = robot;
+		e.format = format;
+		e.argCount = argCount;
+		e.args[0] = arg1;
+		e.args[1] = arg2;
+	}
+
+
+	static Entry _entries[Capacity];
+	static int _first;
+	static int _count;
+	static int _dropped;
+	static bool _viewerAttached;
+};
@@ -0,0 +1,239 @@
+
+#include "PlayFeatures.hpp"
+#include "../World/ShotTarget.hpp"
+#include "../World/FieldModel.hpp"
+#include <gameplay/GameplayModule.hpp>
+
+#include <Constants.hpp>
+
+#include <cmath>
+#include <algorithm>
+#include <boost/foreach.hpp>
+
+using namespace std;
+using namespace Gameplay;
+using namespace Geometry2d;
+
+
+
+const float PlayFeatures::PossessionDistance = 0.15;
+
+PlayFeatures PlayFeatures::_frameFeatures;
+uint64_t PlayFeatures::_frameTimestamp = 0;
+bool PlayFeatures::_frameValid = false;
+
+
+
+//	sorts robot indices by their distance to the ball
+class BallDistanceComparator {
+public:
+	BallDistanceComparator(const vector<float> &dists) : _dists(dists) {}
+
+	bool operator()(int a, int b) const {
+		return _dists[a] < _dists[b];
+	}
+
+private:
+	const vector<float> &_dists;
+};
+
+
+
+PlayFeatures::PlayFeatures() {
+	_extracted = FeatureNone;
+	_ballZone = BallZoneMidfield;
+	_ballSide = BallSideCenter;
+	_nearestOurDist = -1;
+	_nearestOpponentDist = -1;
+	_ourShotAngle = 0;
+	_theirShotAngle = 0;
+	_possession = PossessionFree;
+}
+
+
+
+const PlayFeatures &PlayFeatures::forFrame(GameplayModule *gpModule) {
+	SystemState *state = gpModule->state();
+
+	if ( !_frameValid || state->timestamp != _frameTimestamp ) {
+		//	only extract what at least one enabled play is going to read
+		int mask = FeatureNone;
+		typedef pair<string, PlayFactory *> FactoryEntry;
+		BOOST_FOREACH(FactoryEntry entry, ActionFactory::playFactories()) {
+			PlayFactory *factory = entry.second;
+			if ( factory && factory->enabled() ) mask |= factory->requiredFeatures();
+		}
+
+		_frameFeatures.extract(state, mask);
+		_frameTimestamp = state->timestamp;
+		_frameValid = true;
+	}
+
+	return _frameFeatures;
+}
+
+
+
+void PlayFeatures::extract(SystemState *state, int featureMask) {
+	_extracted = FeatureNone;
+
+	//	possession is derived from the nearest robots
+	if ( featureMask & FeaturePossession ) featureMask |= FeatureNearestRobots;
+
+	if ( featureMask & FeatureBallZone ) extractBallZone(state);
+	if ( featureMask & FeatureNearestRobots ) extractNearestRobots(state);
+	if ( featureMask & FeatureShotAngles ) extractShotAngles(state);
+	if ( featureMask & FeaturePossession ) extractPossession(state);
+}
+
+
+
+void PlayFeatures::require(Feature feature) const {
+	if ( !has(feature) ) {
+		throw string("ERROR: PlayFeatures read a feature that wasn't extracted.  Add it to PlayFactory::requiredFeatures().");
+	}
+}
+
+
+
+void PlayFeatures::extractBallZone(SystemState *state) {
+	const Point &ballPos = state->ball.pos;
+
+	if ( ballPos.y < Field_Length / 3 ) {
+		_ballZone = BallZoneDefense;
+	} else if ( ballPos.y > Field_Length * 2 / 3 ) {
+		_ballZone = BallZoneAttack;
+	} else {
+		_ballZone = BallZoneMidfield;
+	}
+
+	if ( ballPos.x < -Field_Width / 6 ) {
+		_ballSide = BallSideLeft;
+	} else if ( ballPos.x > Field_Width / 6 ) {
+		_ballSide = BallSideRight;
+	} else {
+		_ballSide = BallSideCenter;
+	}
+
+	_extracted |= FeatureBallZone;
+}
+
+
+
+void PlayFeatures::extractNearestRobots(SystemState *state) {
+	const Point &ballPos = state->ball.pos;
+
+	//	our robots
+	vector<float> dists;
+	_ourRobotsByBallDistance.clear();
+	BOOST_FOREACH(OurRobot *r, state->self) {
+		dists.push_back(r ? r->pos.distTo(ballPos) : 0);
+		if ( r && r->visible ) _ourRobotsByBallDistance.push_back(dists.size() - 1);
+	}
+	sort(_ourRobotsByBallDistance.begin(), _ourRobotsByBallDistance.end(), BallDistanceComparator(dists));
+	_nearestOurDist = _ourRobotsByBallDistance.empty() ? -1 : dists[_ourRobotsByBallDistance[0]];
+
+	//	opponents
+	dists.clear();
+	_opponentsByBallDistance.clear();
+	BOOST_FOREACH(OpponentRobot *r, state->opp) {
+		dists.push_back(r ? r->pos.distTo(ballPos) : 0);
+		if ( r && r->visible ) _opponentsByBallDistance.push_back(dists.size() - 1);
+	}
+	sort(_opponentsByBallDistance.begin(), _opponentsByBallDistance.end(), BallDistanceComparator(dists));
+	_nearestOpponentDist = _opponentsByBallDistance.empty() ? -1 : dists[_opponentsByBallDistance[0]];
+
+	_extracted |= FeatureNearestRobots;
+}
+
+
+
+void PlayFeatures::extractShotAngles(SystemState *state) {
+	const Point &ballPos = state->ball.pos;
+
+	//	our shot on their goal is blocked by their robots
+	const Field &field = Field::instance();
+
+	ShotTarget ourShot(ballPos, field.theirGoalLine().pt[0], field.theirGoalLine().pt[1]);
+	BOOST_FOREACH(OpponentRobot *r, state->opp) {
+		if ( r && r->visible ) ourShot.addObstacle(r->pos);
+	}
+	ourShot.run();
+	_ourShotAngle = ourShot.largestOpenAngle();
+
+	//	their shot on our goal is blocked by our robots
+	ShotTarget theirShot(ballPos, field.ourGoalLine().pt[0], field.ourGoalLine().pt[1]);
+	BOOST_FOREACH(OurRobot *r, state->self) {
+		if ( r && r->visible ) theirShot.addObstacle(r->pos);
+	}
+	theirShot.run();
+	_theirShotAngle = theirShot.largestOpenAngle();
+
+	_extracted |= FeatureShotAngles;
+}
+
+
+
+void PlayFeatures::extractPossession(SystemState *state) {
+	bool oursClose = _nearestOurDist >= 0 && _nearestOurDist < PossessionDistance;
+	bool theirsClose = _nearestOpponentDist >= 0 && _nearestOpponentDist < PossessionDistance;
+
+	if ( oursClose && theirsClose ) {
+		_possession = PossessionContested;
+	} else if ( oursClose ) {
+		_possession = PossessionOurs;
+	} else if ( theirsClose ) {
+		_possession = PossessionTheirs;
+	} else {
+		_possession = PossessionFree;
+	}
+
+	_extracted |= FeaturePossession;
+}
+
+
+
+PlayFeatures::BallZone PlayFeatures::ballZone() const {
+	require(FeatureBallZone);
+	return _ballZone;
+}
+
+PlayFeatures::BallSide PlayFeatures::ballSide() const {
+	require(FeatureBallZone);
+	return _ballSide;
+}
+
+const vector<int> &PlayFeatures::ourRobotsByBallDistance() const {
+	require(FeatureNearestRobots);
+	return _ourRobotsByBallDistance;
+}
+
+const vector<int> &PlayFeatures::opponentsByBallDistance() const {
+	require(FeatureNearestRobots);
+	return _opponentsByBallDistance;
+}
+
+float PlayFeatures::nearestOurDist() const {
+	require(FeatureNearestRobots);
+	return _nearestOurDist;
+}
+
+float PlayFeatures::nearestOpponentDist() const {
+	require(FeatureNearestRobots);
+	return _nearestOpponentDist;
+}
+
+float PlayFeatures::ourShotAngle() const {
+	require(FeatureShotAngles);
+	return _ourShotAngle;
+}
+
+float PlayFeatures::theirShotAngle() const {
+	require(FeatureShotAngles);
+	return _theirShotAngle;
+}
+
+PlayFeatures::Possession PlayFeatures::possession() const {
+	require(FeaturePossession);
+	return _possession;
+}
@@ -0,0 +1,130 @@
+
+#pragma once
+
+#include "../../STP.hpp"
+
+#include <vector>
+#include <stdint.h>
+
+
+/**
+ *	Geometric features of the current frame that play scorers are interested in.
+ *
+ *	Every PlayFactory::score() used to derive these on its own, so with many plays the same
+ *	distances and angles were recomputed dozens of times per frame.  Instead, each PlayFactory
+ *	declares the features it reads via requiredFeatures() and the union of those is extracted
+ *	once per frame, before any play is scored.  Features nobody asked for are never computed, but
+ *	a play that doesn't declare anything is given all of them.
+ *
+ *	The PlayFeatures object is immutable once extracted.  Reading a feature that wasn't
+ *	extracted throws an exception - add it to requiredFeatures() instead.
+ */
+class PlayFeatures {
+public:
+
+	///	bit flags - OR these together in PlayFactory::requiredFeatures()
+	typedef enum {
+		FeatureNone				= 0,
+		FeatureBallZone			= 1,	///	which third and side of the field the ball is in
+		FeatureNearestRobots	= 2,	///	robots of each team sorted by distance to the ball
+		FeatureShotAngles		= 4,	///	largest open angle on each goal from the ball
+		FeaturePossession		= 8		///	who has the ball
+	} Feature;
+
+
+	///	field thirds, measured from our goal line
+	typedef enum {
+		BallZoneDefense,
+		BallZoneMidfield,
+		BallZoneAttack
+	} BallZone;
+
+	typedef enum {
+		BallSideLeft,
+		BallSideCenter,
+		BallSideRight
+	} BallSide;
+
+	typedef enum {
+		PossessionFree,			///	nobody is close to the ball
+		PossessionOurs,
+		PossessionTheirs,
+		PossessionContested		///	robots from both teams are close to the ball
+	} Possession;
+
+
+	PlayFeatures();
+
+
+	///	returns the features for the current frame, extracting them if this is the first call of the frame.
+	///	The set extracted is the union of requiredFeatures() over all enabled PlayFactorys.
+	static const PlayFeatures &forFrame(Gameplay::GameplayModule *gpModule);
+
+
+	///	fills in the features in @featureMask from the given state
+	void extract(SystemState *state, int featureMask);
+
+
+	bool has(Feature feature) const {
+		return (_extracted & feature) != 0;
+	}
+
+
+	BallZone ballZone() const;
+	BallSide ballSide() const;
+
+
+	///	indices into SystemState::self and SystemState::opp of the visible robots, closest to the ball first
+	const std::vector<int> &ourRobotsByBallDistance() const;
+	const std::vector<int> &opponentsByBallDistance() const;
+
+	///	distance from the ball to the closest robot of each team, or -1 if that team has no visible robots
+	float nearestOurDist() const;
+	float nearestOpponentDist() const;
+
+
+	///	largest unblocked angle, in radians, from the ball to the opponent's goal mouth
+	float ourShotAngle() const;
+
+	///	largest unblocked angle, in radians, from the ball to our goal mouth
+	float theirShotAngle() const;
+
+
+	Possession possession() const;
+
+
+	///	robots closer than this to the ball are considered to be in control of it
+	static const float PossessionDistance;
+
+
+protected:
+	void require(Feature feature) const;
+
+	void extractBallZone(SystemState *state);
+	void extractNearestRobots(SystemState *state);
+	void extractShotAngles(SystemState *state);
+	void extractPossession(SystemState *state);
+
+
+private:
+	int _extracted;
+
+	BallZone _ballZone;
+	BallSide _ballSide;
+
+	std::vector<int> _ourRobotsByBallDistance;
+	std::vector<int> _opponentsByBallDistance;
+	float _nearestOurDist;
+	float _nearestOpponentDist;
+
+	float _ourShotAngle;
+	float _theirShotAngle;
+
+	Possession _possession;
+
+
+	//	per-frame cache used by forFrame()
+	static PlayFeatures _frameFeatures;
+	static uint64_t _frameTimestamp;
+	static bool _frameValid;
+};
@@ -0,0 +1,97 @@
+
+#include "RoleAllocator.hpp"
+#include "World/InterceptSolver.hpp"
+#include "World/MotionModel.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace Geometry2d;
+
+
+
+REGISTER_CONFIGURABLE(RoleAllocator)
+
+ConfigDouble *RoleAllocator::_hysteresis;
+
+
+
+void RoleAllocator::createConfiguration(Configuration *cfg)
+{
+	_hysteresis = new ConfigDouble(cfg, "Roles/Hysteresis - s", 0.3);
+}
+
+
+
+RoleAllocator::RoleAllocator() {
+	_allocations = 0;
+	_reassignments = 0;
+}
+
+
+
+RoleAllocator &RoleAllocator::shared() {
+	static RoleAllocator allocator;
+	return allocator;
+}
+
+
+
+void RoleAllocator::allocate(const WorldSnapshot &world, const vector<Request> &requests, uint32_t available, vector<int> &robots) {
+	const WorldSnapshot::Team &us = world.us;
+	const int n = requests.size();
+
+	robots.assign(n, -1);
+	_allocations++;
+	if ( n == 0 ) return;
+
+	//	one column per robot slot, so the columns mean the same thing every time and the
+	//	solver's column potentials stay valid for a warm start
+	const int cols = max(us.count, n);
+	const int rows = cols;
+
+	const float maxAccel = InterceptSolver::maxAccel();
+	const float maxSpeed = InterceptSolver::maxSpeed();
+	const float hysteresis = *_hysteresis;
+
+	_cost.assign(rows * cols, 0);
+	_rowToCol.resize(rows);
+
+	for ( int r = 0; r < n; r++ ) {
+		const Request &request = requests[r];
+		float *row = &_cost[r * cols];
+
+		//	flat loop over the robot arrays
+		for ( int j = 0; j < us.count; j++ ) {
+			float dx = request.target.x - us.x[j];
+			float dy = request.target.y - us.y[j];
+			float dist = sqrtf(dx * dx + dy * dy);
+			float v0 = dist > 0 ? (us.vx[j] * dx + us.vy[j] * dy) / dist : 0;
+			row[j] = MotionModel::travelTime(dist, v0, maxAccel, maxSpeed);
+		}
+
+		for ( int j = 0; j < cols; j++ ) {
+			if ( j >= us.count || !(((available & request.robots) >> j) & 1) ) row[j] = Assignment::Forbidden;
+		}
+
+		map<const void *, int>::const_iterator prev = _previous.find(request.key);
+		if ( prev != _previous.end() && prev->second < us.count && row[prev->second] < Assignment::Forbidden ) {
+			row[prev->second] -= hysteresis;
+		}
+	}
+	//	rows past n are dummies that soak up the robots nobody asked for
+
+	_solver.solve(&_cost[0], rows, cols, &_rowToCol[0], true);
+
+	for ( int r = 0; r < n; r++ ) {
+		int j = _rowToCol[r];
+		if ( _cost[r * cols + j] >= Assignment::Forbidden ) continue;
+
+		robots[r] = j;
+
+		map<const void *, int>::iterator prev = _previous.find(requests[r].key);
+		if ( prev != _previous.end() && prev->second != j ) _reassignments++;
+		_previous[requests[r].key] = j;
+	}
+}
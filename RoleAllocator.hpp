@@ -0,0 +1,83 @@
+
+#pragma once
+
+#include "Configuration.hpp"
+#include "World/WorldSnapshot.hpp"
+#include "World/Assignment.hpp"
+
+#include <vector>
+#include <map>
+
+
+/**
+ *	Matches roles to our robots by how long each robot needs to get to where the role wants to
+ *	start.
+ *
+ *	Costs are travel times from the trapezoidal motion model, using each robot's current velocity,
+ *	rather than straight-line distances.  A robot already heading toward a spot is cheaper than an
+ *	equally distant one moving away from it.  The matrix is padded to square with zero-cost dummy
+ *	rows so the Hungarian solver can warm-start from the previous allocation's column potentials.
+ *	A role that goes back to the robot it had last time gets a bonus, so near-ties don't swap
+ *	robots back and forth.
+ *
+ *	One shared allocator is used by all Plays so that the warm start and the hysteresis carry over
+ *	from one sync point to the next.
+ */
+class RoleAllocator {
+public:
+	static void createConfiguration(Configuration *cfg);
+
+
+	///	one role that wants a robot
+	class Request {
+	public:
+		Request(const void *key, const Geometry2d::Point &target, uint32_t robots = ~0u) :
+			key(key), target(target), robots(robots) {}
+
+		///	identifies the role from one allocation to the next, usually the Role pointer
+		const void *key;
+
+		///	where the role wants its robot to start
+		Geometry2d::Point target;
+
+		///	robots able to fill the role, e.g. from CapabilityIndex::satisfying()
+		uint32_t robots;
+	};
+
+
+	RoleAllocator();
+
+
+	static RoleAllocator &shared();
+
+
+	///	Picks a distinct robot out of @available (bits are WorldSnapshot::us indices) for each request.
+	///	@robots receives the chosen index for each request, or -1 if there weren't enough robots.
+	void allocate(const WorldSnapshot &world, const std::vector<Request> &requests, uint32_t available, std::vector<int> &robots);
+
+
+	///	number of allocate() calls
+	int allocations() const {
+		return _allocations;
+	}
+
+	///	requests that were given a different robot than the last time their key was allocated
+	int reassignments() const {
+		return _reassignments;
+	}
+
+
+private:
+	Assignment _solver;
+	std::vector<float> _cost;
+	std::vector<int> _rowToCol;
+
+	///	robot each key got last time
+	std::map<const void *, int> _previous;
+
+	int _allocations;
+	int _reassignments;
+
+
+	static ConfigDouble *_hysteresis;
+};
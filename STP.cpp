@@ -2,6 +2,22 @@
 #include "STP.hpp"
 #include "RoleManager.hpp"
 #include "gameplay/GameplayModule.hpp"
+#include "Plays/PlayFeatures.hpp"
+#include "World/WorldSnapshot.hpp"
+#include "World/SpatialIndex.hpp"
+#include "World/BallModel.hpp"
+#include "World/OpponentPrediction.hpp"
+#include "World/InterceptSolver.hpp"
+#include "World/PassEvaluator.hpp"
+#include "World/ThreatMap.hpp"
+#include "World/SpaceControl.hpp"
+#include "World/CapabilityIndex.hpp"
+#include "RoleAllocator.hpp"
+#include "ConfigSnapshot.hpp"
+#include "DebugChannel.hpp"
+#include "ActionLog.hpp"
+#include "CommandBuffer.hpp"
+#include "Tactics/Goalie.hpp"
 
 #include <boost/make_shared.hpp>
 
@@ -25,6 +41,21 @@ void Action::terminate() {
 
 
 
+void Action::beginFrame(SystemState *state) {
+	//	publish any config edits made since the last frame before anything reads them
+	ConfigSnapshotBase::refreshAll();
+}
+
+
+
+void Action::endFrame(SystemState *state) {
+	//	the frame is over, so the robots get their commands and the viewer its debug output
+	CommandBuffer::flush(state);
+	DebugChannel::flush(state);
+}
+
+
+
 void Action::setState(ActionState newState) {
 	if ( _state != newState ) {
 
@@ -80,17 +111,58 @@ const OpponentRobot *Action::opp(int i) const
 	return systemState()->opp[i];
 }
 
+const WorldSnapshot &Action::world() const
+{
+	return WorldSnapshot::forState(systemState());
+}
 
-/////////////////////////////
+const SpatialIndex &Action::spatialIndex() const
+{
+	return SpatialIndex::forState(systemState());
+}
 
+const BallModel &Action::ballModel() const
+{
+	return BallModel::forState(systemState());
+}
 
+const OpponentPrediction &Action::opponentPrediction() const
+{
+	return OpponentPrediction::forState(systemState());
+}
 
-//==============================================================================
+const InterceptSolver &Action::interceptSolver() const
+{
+	return InterceptSolver::forState(systemState());
+}
+
+const PassEvaluator &Action::passEvaluator() const
+{
+	return PassEvaluator::forState(systemState());
+}
+
+const ThreatMap &Action::threatMap() const
+{
+	return ThreatMap::forState(systemState());
+}
+
+const SpaceControl &Action::spaceControl() const
+{
+	return SpaceControl::forState(systemState());
+}
 
+const CapabilityIndex &Action::capabilities() const
+{
+	return CapabilityIndex::forState(systemState());
+}
 
 
-vector< map<string, ActionFactory *> > ActionFactory::_factoriesByLevel;
-bool ActionFactory::_factoryRegistryIsSetup = false;
+/////////////////////////////
+
+
+
+//==============================================================================
+
 
 
 string &ActionFactory::name() {
@@ -98,36 +170,26 @@ string &ActionFactory::name() {
 }
 
 
-void ActionFactory::_setupFactoryRegistryIfNecessary() {
-	//	setup the registry if necessary
-	if ( !_factoryRegistryIsSetup ) {
-		for ( int i = 0; i < 3; i++ ) {
-			map<string, ActionFactory *> registry;
-			_factoriesByLevel.push_back(registry);
-		}
-
-		_factoryRegistryIsSetup = true;
-	}
+vector< map<string, ActionFactory *> > &ActionFactory::registries() {
+	//	function-local so factories constructed during static initialization can register.
+	//	one registry per ActionAbstractionLevel
+	static vector< map<string, ActionFactory *> > factoriesByLevel(3);
+	return factoriesByLevel;
 }
 
 void ActionFactory::registerFactory(ActionFactory *factory, ActionAbstractionLevel abstractionLevel) {
-	_setupFactoryRegistryIfNecessary();
-	
 	//	register the factory!
-	map<string, ActionFactory *> registry = _factoriesByLevel[abstractionLevel];
-	registry[factory->name()] = factory;
+	factoriesForAbstractionLevel(abstractionLevel)[factory->name()] = factory;
 }
 
 ActionFactory *ActionFactory::getRegisteredFactory(string & name, ActionAbstractionLevel abstractionLevel) {
-	_setupFactoryRegistryIfNecessary();
-
-	map<string, ActionFactory *> registry = _factoriesByLevel[abstractionLevel];
-	return registry[name];
+	map<string, ActionFactory *> &registry = factoriesForAbstractionLevel(abstractionLevel);
+	map<string, ActionFactory *>::iterator itr = registry.find(name);
+	return itr == registry.end() ? NULL : itr->second;
 }
 
 map<string, ActionFactory *> &ActionFactory::factoriesForAbstractionLevel(ActionAbstractionLevel absLevel) {
-	_setupFactoryRegistryIfNecessary();
-	return _factoriesByLevel[absLevel];
+	return registries()[absLevel];
 }
 
 
@@ -146,6 +208,12 @@ OurRobot *SingleRobotAction::robot() {
 
 
 
+RobotCommands &SingleRobotAction::commands() {
+	return CommandBuffer::forRobot(robot());
+}
+
+
+
 //==============================================================================
 
 
@@ -270,6 +338,7 @@ void Play::update() {
 	//	if one of them failed, we have to abort
 	if ( !checkPendingTacticResults() ) {
 		//	aaahhh fuck, one of those damn tactics failed again...
+		logEvent(ActionLog::Error, ActionLog::PlayFailed, "", -1);
 		setState(ActionStateFailed);
 		return;
 	}
@@ -287,6 +356,7 @@ void Play::update() {
 			if ( state == ActionStateCompleted || state == ActionStateEvaluatingSuccess ) {
 				transitionSequenceAtIndex(sequenceIndex);
 			} else if ( state == ActionStateFailed ) {
+				logEvent(ActionLog::Error, ActionLog::PlayFailed, "", sequenceIndex);
 				setState(ActionStateFailed);	//	the Tactic failed, so the Play failed...
 				return;
 			}
@@ -309,6 +379,10 @@ void Play::update() {
 	}
 
 
+	//	get robots moving toward the roles that are about to start
+	prepositionForUpcomingSyncPoints();
+
+
 	//	if there are no sync points left, that means we're at the end
 	if ( _unreachedSyncPoints.size() == 0 ) {
 		if ( _tacticsAwaitingResults.size() > 0 ) {
@@ -455,7 +529,7 @@ void Play::transitionToSyncPointAtIndex(int syncPtIndex) {
 
 	//	we allocate the new roles all at once at the end so that the role manager can find an optimal matching for us.
 	//	if we instead allocated roles one at a time, the role -> robot matching wouldn't be optimal in most cases
-	gameplayModule()->allocateRolesForToplevelAction(this, rolesToAllocate);
+	allocateRoles(rolesToAllocate);
 
 
 	//	mark that we've reached this sync point
@@ -463,13 +537,178 @@ void Play::transitionToSyncPointAtIndex(int syncPtIndex) {
 	_unreachedSyncPoints.erase(thisSyncPtPos);
 
 
+	logEvent(ActionLog::Info, ActionLog::SyncPointReached, _playFactory->_syncPointNames[syncPtIndex].c_str());
+}
+
+
+
+void Play::logEvent(int level, int event, const char *detail, int arg) {
 	#if STP_DEBUG
-	cout << "Play '" << name() << "' transitioned sync pt '" << _playFactory->_syncPointNames[syncPtIndex] << "'" << endl;
+	const string &playName = _playFactory->name();
+	if ( ActionLog::enabled(playName, abstractionLevel(), (ActionLog::Level)level) ) {
+		ActionLog::record((ActionLog::Level)level, (ActionLog::Event)event, systemState()->timestamp, playName, detail, arg);
+	}
 	#endif
 }
 
 
 
+uint32_t Play::idleRobots() {
+	const WorldSnapshot &world = WorldSnapshot::forState(systemState());
+
+	//	new roles aren't allocated yet, so their tactics don't have robots
+	uint32_t idle = world.us.visible;
+	BOOST_FOREACH(Tactic *t, _tacticsBySequenceIndex) {
+		if ( t ) {
+			int i = world.indexOf(t->robot());
+			if ( i >= 0 ) idle &= ~(1u << i);
+		}
+	}
+
+	Tactics::Goalie *goalie = gameplayModule()->goalie();
+	if ( goalie ) {
+		int i = world.indexOf(goalie->robot());
+		if ( i >= 0 ) idle &= ~(1u << i);
+	}
+
+	return idle;
+}
+
+
+
+//	The role manager matches roles to robots by straight-line distance to each role's preferred
+//	initial position.  We do the matching here by travel time instead, then set each role's
+//	preferred position to where its chosen robot already is, which makes our matching the
+//	zero-cost one for the role manager.  Roles belong to the PlayFactory and are shared by every
+//	Play made from it, so their tactics' own positions are put back as soon as it's done.
+void Play::allocateRoles(set<shared_ptr<Role> > &roles) {
+	if ( roles.empty() ) return;
+
+	const WorldSnapshot &world = WorldSnapshot::forState(systemState());
+
+	//	robots already busy with this play's other roles, or in goal, aren't candidates
+	uint32_t available = idleRobots();
+
+	//	only the roles whose tactics have somewhere to be take part
+	vector<RoleAllocator::Request> requests;
+	vector<shared_ptr<Role> > requestRoles;
+	BOOST_FOREACH(Tactic *t, _tacticsBySequenceIndex) {
+		Geometry2d::Point pt;
+		if ( t && roles.find(t->role()) != roles.end() && t->preferredInitialPosition(pt) ) {
+			uint32_t capable = CapabilityIndex::forState(systemState()).satisfying(t->role()->robotRequirements());
+			requests.push_back(RoleAllocator::Request(t->role().get(), pt, capable));
+			requestRoles.push_back(t->role());
+		}
+	}
+
+	vector<int> robots;
+	if ( !requests.empty() ) {
+		RoleAllocator::shared().allocate(world, requests, available, robots);
+
+		for ( int r = 0; r < requests.size(); r++ ) {
+			if ( robots[r] >= 0 ) requestRoles[r]->setPreferredInitialPosition(world.us.pos(robots[r]));
+		}
+	}
+
+	gameplayModule()->allocateRolesForToplevelAction(this, roles);
+
+	for ( int r = 0; r < robots.size(); r++ ) {
+		if ( robots[r] >= 0 ) requestRoles[r]->setPreferredInitialPosition(requests[r].target);
+	}
+}
+
+
+
+const float Play::LookaheadHorizon = 1.5;
+
+
+
+float Play::syncPointETA(int syncPtIndex) {
+	float eta = 0;
+
+	//	every input has to be on its last tactic, and then it's as far away as the slowest one
+	BOOST_FOREACH(int seqIdx, _playFactory->_syncPointInputs[syncPtIndex]) {
+		TacticSequence *seq = _playFactory->tacticSequenceAtIndex(seqIdx);
+		if ( _sequenceStateByIndex[seqIdx] < (int)seq->size() - 1 ) return -1;
+
+		Tactic *t = _tacticsBySequenceIndex[seqIdx];
+		if ( !t || tacticCanBeConsideredCompleted(t) ) continue;
+
+		//	if any input can't estimate, neither can we
+		float remaining = t->timeRemaining();
+		if ( remaining < 0 ) return -1;
+		if ( remaining > eta ) eta = remaining;
+	}
+
+	return eta;
+}
+
+
+
+bool Play::lookaheadTarget(int seqIdx, Geometry2d::Point &pt) {
+	if ( _lookaheadKnown[seqIdx] < 0 ) {
+		//	the stub works it out from its parameters.  instantiating the tactic here would hand it
+		//	the stub's parameter tree, which the tactic deletes when it's destroyed.
+		TacticSequence *seq = _playFactory->tacticSequenceAtIndex(seqIdx);
+
+		Geometry2d::Point target;
+		_lookaheadKnown[seqIdx] = (!seq->empty() && (*seq)[0]->preferredInitialPosition(target)) ? 1 : 0;
+		_lookaheadTargets[seqIdx] = target;
+	}
+
+	pt = _lookaheadTargets[seqIdx];
+	return _lookaheadKnown[seqIdx] == 1;
+}
+
+
+
+//	The roles are pre-assigned through the shared RoleAllocator, keyed by Role, so when the sync
+//	point fires allocateRoles() gets the same robots back from its hysteresis, and they're
+//	already most of the way there.
+void Play::prepositionForUpcomingSyncPoints() {
+	const WorldSnapshot &world = WorldSnapshot::forState(systemState());
+
+	vector<RoleAllocator::Request> requests;
+	set<shared_ptr<Role> > requested;
+	BOOST_FOREACH(int syncPtIndex, _unreachedSyncPoints) {
+		float eta = syncPointETA(syncPtIndex);
+		if ( eta < 0 || eta > LookaheadHorizon ) continue;
+
+		BOOST_FOREACH(int outputSeqIdx, _playFactory->_syncPointOutputs[syncPtIndex]) {
+			shared_ptr<Role> role = _playFactory->roleForTacticSequenceAtIndex(outputSeqIdx);
+			if ( !role || requested.count(role) ) continue;
+
+			//	roles that are already running keep their robots through the sync point
+			bool running = false;
+			BOOST_FOREACH(Tactic *t, _tacticsBySequenceIndex) {
+				if ( t && t->role() == role ) running = true;
+			}
+			if ( running ) continue;
+
+			Geometry2d::Point target;
+			if ( !lookaheadTarget(outputSeqIdx, target) ) continue;
+
+			uint32_t capable = CapabilityIndex::forState(systemState()).satisfying(role->robotRequirements());
+			requests.push_back(RoleAllocator::Request(role.get(), target, capable));
+			requested.insert(role);
+		}
+	}
+	if ( requests.empty() ) return;
+
+	vector<int> robots;
+	RoleAllocator::shared().allocate(world, requests, idleRobots(), robots);
+
+	for ( int r = 0; r < requests.size(); r++ ) {
+		if ( robots[r] < 0 ) continue;
+
+		OurRobot *robot = world.ourRobot(robots[r]);
+		DebugChannel::text(robot, "Pre-positioning");
+		CommandBuffer::forRobot(robot).move(requests[r].target);
+	}
+}
+
+
+
 bool Play::checkPendingTacticResults() {
 
 	//	iterate through each of the pending tactics
@@ -503,6 +742,8 @@ void Play::initializeIvars() {
 	int sequenceCount = _playFactory->_tacticSequences.size();
 	_sequenceStateByIndex.resize(sequenceCount, -1);		//	set all states to -1
 	_tacticsBySequenceIndex.resize(sequenceCount, NULL);	//	empty set of Tactics
+	_lookaheadKnown.resize(sequenceCount, -1);
+	_lookaheadTargets.resize(sequenceCount);
 
 	//	populate _unreachedSyncPoint array
 	int syncPtCount = _playFactory->_syncPointNames.size();
@@ -529,6 +770,12 @@ Action *PlayFactory::create(GameplayModule *gameplayModule) {
 
 
 
+const PlayFeatures &PlayFactory::features(GameplayModule *gpModule) {
+	return PlayFeatures::forFrame(gpModule);
+}
+
+
+
 shared_ptr<Role> PlayFactory::roleNamed(std::string &name) {
 	return _rolesByName[name];
 }
@@ -582,6 +829,23 @@ void PlayFactory::ensureTacticSequenceValidity(TacticSequence *ts) {
 
 
 
+//	maps between RobotRequirements and the 3-bit combination indices used by _rolesRequiring
+static RobotRequirements requirementsForCombination(int c) {
+	int reqs = RobotRequirementNone;
+	if ( c & 1 ) reqs |= RobotRequirementKicker;
+	if ( c & 2 ) reqs |= RobotRequirementChipper;
+	if ( c & 4 ) reqs |= RobotRequirementDribbler;
+	return (RobotRequirements)reqs;
+}
+
+static int combinationForRequirements(RobotRequirements reqs) {
+	return ((reqs & RobotRequirementKicker) ? 1 : 0) |
+		   ((reqs & RobotRequirementChipper) ? 2 : 0) |
+		   ((reqs & RobotRequirementDribbler) ? 4 : 0);
+}
+
+
+
 void PlayFactory::updateRoleRequirements() {
 	//	iterate over all of the sequences
 	for ( int seqIdx = 0; seqIdx < _rolesByTacticSequenceIndex.size(); seqIdx++ ) {
@@ -589,7 +853,7 @@ void PlayFactory::updateRoleRequirements() {
 		shared_ptr<Role> role = roleForTacticSequenceAtIndex(seqIdx);
 		
 		//	add requirements from the tasks in the sequence into the requirements for the role.
-		RobotRequirements reqs;
+		RobotRequirements reqs = RobotRequirementNone;
 		for ( int i = 0; i < sequence->size(); i++ ) {
 			TacticStub *t = (*sequence)[i];
 			TacticFactory *f = t->factory();
@@ -598,6 +862,33 @@ void PlayFactory::updateRoleRequirements() {
 		reqs = (RobotRequirements)(reqs | role->robotRequirements() );
 		role->setRobotRequirements(reqs);
 	}
+
+
+	//	count the roles needing each combination of capabilities.  a Role can have several sequences.
+	//	all of the play's roles are counted together, not per phase between sync points
+	for ( int c = 0; c < 8; c++ ) _rolesRequiring[c] = 0;
+
+	set<shared_ptr<Role> > counted;
+	BOOST_FOREACH(shared_ptr<Role> role, _rolesByTacticSequenceIndex) {
+		if ( !role || !counted.insert(role).second ) continue;
+
+		int needs = combinationForRequirements(role->robotRequirements());
+		for ( int c = 0; c < 8; c++ ) {
+			if ( (needs & c) == c ) _rolesRequiring[c]++;
+		}
+	}
+}
+
+
+
+bool PlayFactory::robotsAvailableForRoles(GameplayModule *gpModule) {
+	const CapabilityIndex &caps = CapabilityIndex::forState(gpModule->state());
+
+	for ( int c = 0; c < 8; c++ ) {
+		if ( _rolesRequiring[c] > caps.count(requirementsForCombination(c)) ) return false;
+	}
+
+	return true;
 }
 
 
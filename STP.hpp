@@ -3,6 +3,7 @@
 
 #include <string>
 #include <iostream>
+#include <set>
 #include <boost/shared_ptr.hpp>
 
 #include "Role.hpp"
@@ -11,7 +12,10 @@
 #include <framework/SystemState.hpp>
 
 
+///	set STP_DEBUG to 0 to compile out the ActionLog calls
+#ifndef STP_DEBUG
 #define STP_DEBUG 1
+#endif
 
 
 
@@ -19,6 +23,17 @@ namespace Gameplay {
 	class GameplayModule;
 }
 
+class WorldSnapshot;
+class SpatialIndex;
+class BallModel;
+class OpponentPrediction;
+class InterceptSolver;
+class PassEvaluator;
+class ThreatMap;
+class SpaceControl;
+class CapabilityIndex;
+class RobotCommands;
+
 
 
 typedef enum {
@@ -96,6 +111,15 @@ public:
 	///	gets get called repeatedly while the Action is live
 	virtual void update() {};
 
+
+	///	Per-tick work that isn't any one Action's.  The GameplayModule calls beginFrame() before it
+	///	updates any Action, and endFrame() after the last one (the play, the goalie, and anything
+	///	else it runs), even on ticks with no play running.
+	///	beginFrame() takes config edits made since the last tick, and endFrame() sends every
+	///	robot its buffered commands, publishes them to the radio, and sends the debug output.
+	static void beginFrame(SystemState *state);
+	static void endFrame(SystemState *state);
+
 	
 	///	cancels the Action and stops it from running
 	///	note: terminating an Action that doesn't evaluate success transitions it to the Completed state
@@ -157,6 +181,33 @@ protected:
 
 	const OpponentRobot *opp(int i) const;
 
+	///	flat, per-tick copy of the robots and ball - prefer this over self() and opp() in loops
+	const WorldSnapshot &world() const;
+
+	///	grid of both teams and the ball for proximity queries, shared by all Actions
+	const SpatialIndex &spatialIndex() const;
+
+	///	shared prediction of the ball's trajectory for this frame
+	const BallModel &ballModel() const;
+
+	///	predicted opponent positions and headings for this frame
+	const OpponentPrediction &opponentPrediction() const;
+
+	///	earliest point each of our robots can meet the ball, solved once per frame
+	const InterceptSolver &interceptSolver() const;
+
+	///	scores of candidate pass receive points for this frame
+	const PassEvaluator &passEvaluator() const;
+
+	///	opponent threat, our coverage and occupancy rasters with constant-time region sums
+	const ThreatMap &threatMap() const;
+
+	///	which team, and which robot, gets to each part of the field first
+	const SpaceControl &spaceControl() const;
+
+	///	bitsets of which of our robots can kick, chip and dribble right now
+	const CapabilityIndex &capabilities() const;
+
 ///////////////////////////////////
 	
 	
@@ -175,6 +226,7 @@ private:
 
 
 class PlayFactory;
+class PlayFeatures;
 
 
 ///	http://en.wikipedia.org/wiki/Abstract_factory_pattern
@@ -210,10 +262,6 @@ public:
 	}
 
 	
-protected:
-	static void _setupFactoryRegistryIfNecessary();
-
-	
 private:
 	std::string _name;
 
@@ -224,8 +272,7 @@ private:
 	///	[0] Skills?
 	///	[1] Tactics
 	///	[2]	Plays
-	static std::vector< std::map<std::string, ActionFactory *> > _factoriesByLevel;
-	static bool _factoryRegistryIsSetup;
+	static std::vector< std::map<std::string, ActionFactory *> > &registries();
 };
 
 
@@ -252,6 +299,9 @@ public:
 
 
 	virtual RobotRequirements robotRequirements() const = 0;
+
+	///	see Tactic::initialPositionFromParameters()
+	virtual bool initialPositionFromParameters(ValueTree *params, Geometry2d::Point &pt) const = 0;
 };
 
 
@@ -273,6 +323,10 @@ public:
 		return T::robotRequirements;
 	}
 
+	virtual bool initialPositionFromParameters(ValueTree *params, Geometry2d::Point &pt) const {
+		return T::initialPositionFromParameters(params, pt);
+	}
+
 };
 
 
@@ -308,6 +362,10 @@ public:
 	///	looks up the OurRobot corresponding to _role in the GameplayModule
 	OurRobot *robot();
 
+	///	robot()'s commands for this frame.  Write commands here instead of to robot() so the
+	///	robot only gets the last one of each kind, once, when the frame ends.
+	RobotCommands &commands();
+
 private:
 	boost::shared_ptr<Role> _role;
 	// RobotRequirements _robotRequirements;
@@ -365,6 +423,24 @@ public:
 	///	if the Tactic has a preferred initial location or something, it should set it on the role here.
 	virtual void setPreferencesForRole(boost::shared_ptr<Role> role) {};
 
+	///	where the Tactic would like its robot to start, used by the Play to pick robots by travel time.
+	///	returns false if it doesn't care.
+	virtual bool preferredInitialPosition(Geometry2d::Point &pt) const {
+		return false;
+	}
+
+	///	the same as preferredInitialPosition(), worked out from invocation parameters before the
+	///	Tactic exists.  Subclasses that know their start position hide this with their own version.
+	static bool initialPositionFromParameters(ValueTree *params, Geometry2d::Point &pt) {
+		return false;
+	}
+
+	///	estimated seconds until the Tactic completes, or -1 if it has no idea.
+	///	Plays use this to see sync points coming and get robots moving early.
+	virtual float timeRemaining() {
+		return -1;
+	}
+
 
 protected:
 
@@ -422,6 +498,12 @@ public:
 		return (TacticFactory *)ActionFactory::getRegisteredFactory(name(), ActionAbstractionLevelTactic);
 	}
 
+	///	where the Tactic will want its robot to start, without instantiating it
+	bool preferredInitialPosition(Geometry2d::Point &pt) {
+		TacticFactory *f = factory();
+		return f && f->initialPositionFromParameters(_invocationParameters, pt);
+	}
+
 private:
 	std::string _name;
 	ValueTree *_invocationParameters;
@@ -486,6 +568,28 @@ protected:
 	//	note: only call this if it is reachable
 	void transitionToSyncPointAtIndex(int syncPtIndex);
 
+	//	allocates @roles through the role manager, steering it to the robots with the shortest
+	//	travel times to the roles' preferred positions
+	void allocateRoles(std::set<boost::shared_ptr<Role> > &roles);
+
+	//	bitmask of WorldSnapshot::us indices that aren't running this play's tactics or playing goalie
+	uint32_t idleRobots();
+
+
+	///	Sync points predicted to become reachable within this many seconds have their new roles
+	///	pre-assigned to idle robots, which start driving to the roles' preferred positions.
+	static const float LookaheadHorizon;
+
+	//	estimated seconds until the sync point is reachable, or -1 if it isn't close yet or one of
+	//	its running inputs can't estimate how long it has left
+	float syncPointETA(int syncPtIndex);
+
+	//	moves idle robots toward the starting positions of roles in upcoming sync points
+	void prepositionForUpcomingSyncPoints();
+
+	//	preferred starting position of the first tactic in a sequence, cached after the first call
+	bool lookaheadTarget(int seqIdx, Geometry2d::Point &pt);
+
 	
 	//	sequence indices of -1 indicate that the Role is coming from or going to purgatory
 	bool transitionRole(boost::shared_ptr<Role> role, int currSeqIdx, int newSeqIdx);
@@ -500,6 +604,10 @@ protected:
 	///	returns false if one of the tactics awaiting results failed
 	bool checkPendingTacticResults();
 
+	//	records @event for this play in the ActionLog if it's logging at @level.  @level and @event
+	//	are an ActionLog::Level and ActionLog::Event, which this header can't see.
+	void logEvent(int level, int event, const char *detail = "", int arg = 0);
+
 
 	boost::shared_ptr<Role> roleForTacticSequenceAtIndex(int sequenceIndex);
 
@@ -531,7 +639,10 @@ private:
 	std::vector<Tactic *> _tacticsAwaitingResults;
 
 
-	bool _debugLogging;	//	if true, prints a bunch of garbage to stdout
+	//	lookaheadTarget() cache: -1 = not looked up yet, 0 = no preference, 1 = _lookaheadTargets is valid
+	std::vector<int> _lookaheadKnown;
+	std::vector<Geometry2d::Point> _lookaheadTargets;
+
 };
 
 
@@ -551,6 +662,7 @@ public:
 		_finalized = false;
 		_enabled = true;
 		_category = category;
+		for ( int c = 0; c < 8; c++ ) _rolesRequiring[c] = 0;
 	}
 
 	virtual Action *create(Gameplay::GameplayModule *gameplayModule);
@@ -567,6 +679,19 @@ public:
 	}
 
 
+	///	OR of the PlayFeatures::Feature flags that score() reads.
+	///	Only features that some enabled play requires get extracted each frame.  Plays that don't
+	///	say get every feature, so override this to narrow it once score() uses features().
+	virtual int requiredFeatures() const {
+		return ~0;
+	}
+
+
+	///	the features shared by all play scorers for the current frame
+	///	note: use this from score() instead of deriving geometry from the SystemState
+	const PlayFeatures &features(Gameplay::GameplayModule *gpModule);
+
+
 	///	returns true if score() == -1
 	bool applicable(Gameplay::GameplayModule *gpModule) {
 		float s = score(gpModule);
@@ -607,6 +732,15 @@ public:
 	void ensureTacticSequenceValidity(TacticSequence *ts);
 
 
+	///	Quick check that there are enough capable robots for the play's roles: for every combination
+	///	of requirements, the robots that have it must be at least as many as the roles that need it.
+	///	Costs a few bit operations.
+	///	This is pessimistic: every role in the play is counted as if they all ran at once, so a play
+	///	whose roles take turns between sync points can be rejected even though it would have enough
+	///	robots for each phase.  Passing doesn't guarantee an allocation exists either.
+	bool robotsAvailableForRoles(Gameplay::GameplayModule *gpModule);
+
+
 	///	how many robots are used simultaneously during the play?
 	int maxSimultaneousRobots() const {
 		//	FIXME: implement
@@ -667,6 +801,11 @@ private:
 	bool _enabled;
 
 
+	///	_rolesRequiring[c] = number of roles that need every capability in combination c, where
+	///	bit 0 of c is the kicker, bit 1 the chipper and bit 2 the dribbler
+	int _rolesRequiring[8];
+
+
 	std::string _category;
 
 
@@ -1,5 +1,7 @@
 
 #include "Bump.hpp"
+#include "../DebugChannel.hpp"
+#include "../CommandBuffer.hpp"
 #include <stdio.h>
 
 using namespace Geometry2d;
@@ -18,6 +20,10 @@ ConfigDouble *Skills::Bump::_bump_complete_dist;
 ConfigDouble *Skills::Bump::_accel_bias;
 ConfigDouble *Skills::Bump::_facing_thresh;
 
+#ifndef STP_COMPETITION
+ConfigSnapshot<Skills::Bump::Params> Skills::Bump::_params(&Skills::Bump::loadParams);
+#endif
+
 void Skills::Bump::createConfiguration(Configuration *cfg)
 {
 	_drive_around_dist = new ConfigDouble(cfg, "Bump/Drive Around Dist", 0.45);
@@ -30,6 +36,21 @@ void Skills::Bump::createConfiguration(Configuration *cfg)
 	_facing_thresh = new ConfigDouble(cfg, "Bump/Facing Thresh - Deg", 10);
 }
 
+#ifndef STP_COMPETITION
+void Skills::Bump::loadParams(Params &p)
+{
+	p.driveAroundDist = *_drive_around_dist;
+	p.setupToChargeThresh = *_setup_to_charge_thresh;
+	p.escapeChargeThresh = *_escape_charge_thresh;
+	p.setupBallAvoid = *_setup_ball_avoid;
+	p.bumpCompleteDist = *_bump_complete_dist;
+	p.facingThresh = *_facing_thresh;
+	p.accelBias = *_accel_bias;
+	p.faceBall = *_face_ball;
+	p.cosFacingThresh = cos(p.facingThresh * DegreesToRadians);
+}
+#endif
+
 Skills::Bump::Bump(Gameplay::GameplayModule *gameplay) :
     Skill(gameplay)
 {
@@ -50,17 +71,18 @@ void Skills::Bump::update()
 	
 
 	if ( state() == ActionStateRunning ) {
+		const Params params = Skills::Bump::params();
 
 		Line targetLine(ball().pos, target);
 		const Point dir = Point::direction(robot()->angle * DegreesToRadians);
-		double facing_thresh = cos(*_facing_thresh * DegreesToRadians);
+		double facing_thresh = params.cosFacingThresh;
 		double facing_err = dir.dot((target - ball().pos).normalized());
 	//	robot->addText(QString("Err:%1,T:%2").arg(facing_err).arg(facing_thresh));
 
 		// State changes
 		if (_subState == State_Setup)
 		{
-			if (targetLine.distTo(robot()->pos) <= *_setup_to_charge_thresh &&
+			if (targetLine.distTo(robot()->pos) <= params.setupToChargeThresh &&
 					targetLine.delta().dot(robot()->pos - ball().pos) <= -Robot_Radius &&
 					facing_err >= facing_thresh)
 			{
@@ -68,14 +90,14 @@ void Skills::Bump::update()
 			}
 		} else if (_subState == State_Charge)
 		{
-			if (Line(robot()->pos, target).distTo(ball().pos) > *_escape_charge_thresh)
+			if (Line(robot()->pos, target).distTo(ball().pos) > params.escapeChargeThresh)
 			{
 				// Ball is in a bad place
 				_subState = State_Setup;
 			}
 
 			// FIXME: should finish at some point, but this condition is bad
-	//		if (!robot->pos.nearPoint(ball().pos, *_bump_complete_dist))
+	//		if (!robot->pos.nearPoint(ball().pos, params.bumpCompleteDist))
 	//		{
 	//			_subState = State_Done;
 	//		}
@@ -85,43 +107,43 @@ void Skills::Bump::update()
 		if (_subState == State_Setup)
 		{
 			// Move onto the line containing the ball and the_setup_ball_avoid target
-			robot()->addText(QString("%1").arg(targetLine.delta().dot(robot()->pos - ball().pos)));
-			Segment behind_line(ball().pos - targetLine.delta().normalized() * (*_drive_around_dist + Robot_Radius),
+			DebugChannel::text(robot(), "%1", targetLine.delta().dot(robot()->pos - ball().pos));
+			Segment behind_line(ball().pos - targetLine.delta().normalized() * (params.driveAroundDist + Robot_Radius),
 					ball().pos - targetLine.delta().normalized() * 5.0);
 			if (targetLine.delta().dot(robot()->pos - ball().pos) > -Robot_Radius)
 			{
 				// We're very close to or in front of the ball
-				robot()->addText("In front");
-				robot()->avoidBall(*_setup_ball_avoid);
-				robot()->move(ball().pos - targetLine.delta().normalized() * (*_drive_around_dist + Robot_Radius));
+				DebugChannel::text(robot(), "In front");
+				commands().avoidBall(params.setupBallAvoid);
+				commands().move(ball().pos - targetLine.delta().normalized() * (params.driveAroundDist + Robot_Radius));
 			} else {
 				// We're behind the ball
-				robot()->addText("Behind");
-				robot()->avoidBall(*_setup_ball_avoid);
-				robot()->move(behind_line.nearestPoint(robot()->pos));
-				systemState()->drawLine(behind_line);
+				DebugChannel::text(robot(), "Behind");
+				commands().avoidBall(params.setupBallAvoid);
+				commands().move(behind_line.nearestPoint(robot()->pos));
+				DebugChannel::line(behind_line);
 			}
 
 			// face in a direction so that on impact, we aim at goal
 			Point delta_facing = target - ball().pos;
-			robot()->face(robot()->pos + delta_facing);
+			commands().face(robot()->pos + delta_facing);
 
 		} else if (_subState == State_Charge)
 		{
-			robot()->addText("Charge!");
-			systemState()->drawLine(robot()->pos, target, Qt::white);
-			systemState()->drawLine(ball().pos, target, Qt::white);
+			DebugChannel::text(robot(), "Charge!");
+			DebugChannel::line(robot()->pos, target, DebugChannel::White);
+			DebugChannel::line(ball().pos, target, DebugChannel::White);
 
 			Point ballToTarget = (target - ball().pos).normalized();
 	//		Point robotToBall = (ball().pos - robot->pos).normalized();
 			Point driveDirection = (ball().pos - ballToTarget * Robot_Radius) - robot()->pos;
 			
 			//We want to move in the direction of the target without path planning
-			double speed =  robot()->vel.mag() + *_accel_bias; // enough of a bias to force it to accelerate
-			robot()->worldVelocity(driveDirection.normalized() * speed);
-			robot()->angularVelocity(0.0);
+			double speed =  robot()->vel.mag() + params.accelBias; // enough of a bias to force it to accelerate
+			commands().worldVelocity(driveDirection.normalized() * speed);
+			commands().angularVelocity(0.0);
 		} else {
-			robot()->addText("Done");
+			DebugChannel::text(robot(), "Done");
 			setState(ActionStateCompleted);
 		}
 
@@ -3,6 +3,10 @@
 
 #include "../../STP.hpp"
 #include "../../Configuration.hpp"
+#include "../ConfigSnapshot.hpp"
+#ifdef STP_COMPETITION
+#include "../CompetitionConfig.hpp"
+#endif
 
 
 namespace Skills {
@@ -30,6 +34,45 @@ namespace Skills {
 			State_Done
 		} _subState;
 
+		///	the tunables, read together once per update()
+		struct Params {
+			float driveAroundDist;
+			float setupToChargeThresh;
+			float escapeChargeThresh;
+			float setupBallAvoid;
+			float bumpCompleteDist;
+			float facingThresh;
+			float accelBias;
+			bool faceBall;
+
+			///	cos(facingThresh), so update() doesn't take a cosine every frame
+			float cosFacingThresh;
+		};
+
+#ifdef STP_COMPETITION
+		///	the tuned values, baked in so the compiler can fold them
+		static Params params() {
+			Params p;
+			p.driveAroundDist = CompetitionConfig::Bump::DriveAroundDist;
+			p.setupToChargeThresh = CompetitionConfig::Bump::ChargeThresh;
+			p.escapeChargeThresh = CompetitionConfig::Bump::EscapeChargeThresh;
+			p.setupBallAvoid = CompetitionConfig::Bump::SetupBallAvoid;
+			p.bumpCompleteDist = CompetitionConfig::Bump::BumpCompleteDistance;
+			p.facingThresh = CompetitionConfig::Bump::FacingThreshDeg;
+			p.accelBias = CompetitionConfig::Bump::AccelBias;
+			p.faceBall = CompetitionConfig::Bump::FaceBallOtherwiseTarget;
+			p.cosFacingThresh = cos(p.facingThresh * DegreesToRadians);
+			return p;
+		}
+#else
+		static Params params() {
+			return _params.read();
+		}
+
+		static void loadParams(Params &p);
+		static ConfigSnapshot<Params> _params;
+#endif
+
 		static ConfigBool *_face_ball;
 		static ConfigDouble *_drive_around_dist;
 		static ConfigDouble *_setup_to_charge_thresh;
@@ -1,5 +1,10 @@
 
 #include "LineKick.hpp"
+#include "../World/BallModel.hpp"
+#include "../World/ShotTarget.hpp"
+#include "../World/FieldModel.hpp"
+#include "../DebugChannel.hpp"
+#include "../CommandBuffer.hpp"
 
 #include <stdio.h>
 
@@ -19,8 +24,12 @@ ConfigDouble *Skills::LineKick::_accel_bias;
 ConfigDouble *Skills::LineKick::_facing_thresh;
 ConfigDouble *Skills::LineKick::_max_speed;
 ConfigDouble *Skills::LineKick::_proj_time;
-ConfigDouble *Skills::LineKick::_dampening;
 ConfigDouble *Skills::LineKick::_done_thresh;
+ConfigDouble *Skills::LineKick::_setup_move_tolerance;
+
+#ifndef STP_COMPETITION
+ConfigSnapshot<Skills::LineKick::Params> Skills::LineKick::_params(&Skills::LineKick::loadParams);
+#endif
 
 
 
@@ -34,9 +43,26 @@ void Skills::LineKick::createConfiguration(Configuration *cfg)
 	_facing_thresh = new ConfigDouble(cfg, "LineKick/Facing Thresh - Deg", 10);
 	_max_speed = new ConfigDouble(cfg, "LineKick/Max Charge Speed", 1.5);
 	_proj_time = new ConfigDouble(cfg, "LineKick/Ball Project Time", 0.4);
-	_dampening = new ConfigDouble(cfg, "LineKick/Ball Project Dampening", 0.8);
 	_done_thresh = new ConfigDouble(cfg, "LineKick/Done State Thresh", 0.11);
+	_setup_move_tolerance = new ConfigDouble(cfg, "LineKick/Setup Move Tolerance", 0.02);
+}
+
+#ifndef STP_COMPETITION
+void Skills::LineKick::loadParams(Params &p)
+{
+	p.driveAroundDist = *_drive_around_dist;
+	p.setupToChargeThresh = *_setup_to_charge_thresh;
+	p.escapeChargeThresh = *_escape_charge_thresh;
+	p.setupBallAvoid = *_setup_ball_avoid;
+	p.accelBias = *_accel_bias;
+	p.facingThresh = *_facing_thresh;
+	p.maxSpeed = *_max_speed;
+	p.projTime = *_proj_time;
+	p.doneThresh = *_done_thresh;
+	p.setupMoveTolerance = *_setup_move_tolerance;
+	p.cosFacingThresh = cos(p.facingThresh * DegreesToRadians);
 }
+#endif
 
 Skills::LineKick::LineKick(Gameplay::GameplayModule *gpModule) :
     Skill(gpModule, false, false),	//	FIXME: should it evaluate success?
@@ -45,6 +71,7 @@ Skills::LineKick::LineKick(Gameplay::GameplayModule *gpModule) :
 	restart();
 	target = Geometry2d::Point(0.0, Field_Length);
 	enable_kick = true;
+	auto_target = false;
 }
 
 
@@ -74,19 +101,27 @@ void Skills::LineKick::update() {
 
 	if ( state() == ActionStateRunning ) {
 		OurRobot *theRobot = robot();
+		const Params params = Skills::LineKick::params();
 
 
 		// project the ball ahead to handle movement
-		double dt = *_proj_time;
-		Point ballPos = ball().pos + ball().vel * dt * _dampening->value();  // projecting
-		//	Point ballPos = ball().pos; // no projecting
+		Point ballPos = ballModel().pos(params.projTime);
+
+		// pick the best spot on the goal while lining up, then commit to it for the charge
+		if (auto_target && _subState == State_Setup)
+		{
+			Point bestTarget;
+			if (ShotTarget::atOpponentGoal(systemState(), ballPos).best(bestTarget))
+				target = bestTarget;
+		}
+
 		Line targetLine(ballPos, target);
 		const Point dir = Point::direction(theRobot->angle * DegreesToRadians);
-		double facing_thresh = cos(*_facing_thresh * DegreesToRadians);
+		double facing_thresh = params.cosFacingThresh;
 		double facing_err = dir.dot((target - ballPos).normalized());
 		
 
-		if(ballPos.distTo(theRobot->pos) <= *_done_thresh)
+		if(ballPos.distTo(theRobot->pos) <= params.doneThresh)
 		{
 			ballClose = true;
 		}
@@ -94,7 +129,7 @@ void Skills::LineKick::update() {
 		// State changes
 		if (_subState == State_Setup)
 		{
-			if (targetLine.distTo(theRobot->pos) <= *_setup_to_charge_thresh &&
+			if (targetLine.distTo(theRobot->pos) <= params.setupToChargeThresh &&
 					targetLine.delta().dot(theRobot->pos - ballPos) <= -Robot_Radius &&
 					facing_err >= facing_thresh &&
 					theRobot->vel.mag() < 0.05)
@@ -112,20 +147,20 @@ void Skills::LineKick::update() {
 			}
 
 			//if the ball if further away than the back off distance for the setup stage
-			if(ballClose && ballPos.distTo(theRobot->pos) > *_drive_around_dist + Robot_Radius)
+			if(ballClose && ballPos.distTo(theRobot->pos) > params.driveAroundDist + Robot_Radius)
 			{
 				_subState = State_Done;
 			}
 		} else if (_subState == State_Charge)
 		{
-			if (Line(theRobot->pos, target).distTo(ballPos) > *_escape_charge_thresh)
+			if (Line(theRobot->pos, target).distTo(ballPos) > params.escapeChargeThresh)
 			{
 				// Ball is in a bad place
 				_subState = State_Setup;
 			}
 
 			//if the ball if further away than the back off distance for the setup stage
-			if(ballClose && ballPos.distTo(theRobot->pos) > *_drive_around_dist + Robot_Radius)
+			if(ballClose && ballPos.distTo(theRobot->pos) > params.driveAroundDist + Robot_Radius)
 			{
 				_subState = State_Done;
 			}
@@ -135,17 +170,17 @@ void Skills::LineKick::update() {
 		if (_subState == State_Setup)
 		{
 			// Move onto the line containing the ball and the_setup_ball_avoid target
-			theRobot->addText(QString("%1").arg(targetLine.delta().dot(theRobot->pos - ballPos)));
-			Point moveGoal = ballPos - targetLine.delta().normalized() * (*_drive_around_dist + Robot_Radius);
+			DebugChannel::text(theRobot, "%1", targetLine.delta().dot(theRobot->pos - ballPos));
+			Point moveGoal = ballPos - targetLine.delta().normalized() * (params.driveAroundDist + Robot_Radius);
 
-			static const Segment left_field_edge(Point(-Field_Width / 2.0, 0.0), Point(-Field_Width / 2.0, Field_Length));
-			static const Segment right_field_edge(Point(Field_Width / 2.0, 0.0), Point(Field_Width / 2.0, Field_Length));
+			const Segment &left_field_edge = Field::instance().leftEdge();
+			const Segment &right_field_edge = Field::instance().rightEdge();
 
 			// Handle edge of field case
 			float field_edge_thresh = 0.3;
-			Segment behind_line(ballPos - targetLine.delta().normalized() * (*_drive_around_dist),
+			Segment behind_line(ballPos - targetLine.delta().normalized() * (params.driveAroundDist),
 					ballPos - targetLine.delta().normalized() * 1.0);
-			systemState()->drawLine(behind_line);
+			DebugChannel::line(behind_line);
 			Point intersection;
 			if (left_field_edge.nearPoint(ballPos, field_edge_thresh) && behind_line.intersects(left_field_edge, &intersection))   /// kick off left edge of far half fieldlPos, field_edge_thresh) && behind_line.intersects(left_field_edge, &intersection))
 			{
@@ -155,43 +190,43 @@ void Skills::LineKick::update() {
 				moveGoal = intersection;
 			}
 
-			theRobot->addText("Setup");
-			theRobot->avoidBall(*_setup_ball_avoid);
-			theRobot->move(moveGoal);
+			DebugChannel::text(theRobot, "Setup");
+			commands().avoidBall(params.setupBallAvoid);
+			commands().moveWithin(moveGoal, params.setupMoveTolerance);
 
 			// face in a direction so that on impact, we aim at goal
 			Point delta_facing = target - ballPos;
-			theRobot->face(theRobot->pos + delta_facing);
+			commands().face(theRobot->pos + delta_facing);
 
-			theRobot->kick(0);
+			commands().kick(0);
 
 		} else if (_subState == State_Charge)
 		{
-			theRobot->addText("Charge!");
+			DebugChannel::text(theRobot, "Charge!");
 			if (use_chipper)
 			{
-				theRobot->chip(kick_power);
+				commands().chip(kick_power);
 			} else
 			{
-				theRobot->kick(kick_power);
+				commands().kick(kick_power);
 			}
 
 
-			systemState()->drawLine(theRobot->pos, target, Qt::white);
-			systemState()->drawLine(ballPos, target, Qt::white);
+			DebugChannel::line(theRobot->pos, target, DebugChannel::White);
+			DebugChannel::line(ballPos, target, DebugChannel::White);
 			Point ballToTarget = (target - ballPos).normalized();
 			Point theRobotToBall = (ballPos - theRobot->pos).normalized();
 			Point driveDirection = theRobotToBall;
 
 			// Drive directly into the ball
-			double speed = min(theRobot->vel.mag() + (*_accel_bias * scaleAcc), _max_speed->value()); // enough of a bias to force it to accelerate
-			theRobot->worldVelocity(driveDirection.normalized() * speed);
+			double speed = min(theRobot->vel.mag() + (params.accelBias * scaleAcc), params.maxSpeed); // enough of a bias to force it to accelerate
+			commands().worldVelocity(driveDirection.normalized() * speed);
 
 			// scale everything to adjust precision
-			theRobot->setWScale(scaleW);
-			theRobot->setVScale(scaleSpeed);
+			commands().setWScale(scaleW);
+			commands().setVScale(scaleSpeed);
 
-			theRobot->face(ballPos);
+			commands().face(ballPos);
 
 		} else {
 			setState(ActionStateCompleted);
@@ -3,6 +3,10 @@
 
 #include "../../STP.hpp"
 #include "../../Configuration.hpp"
+#include "../ConfigSnapshot.hpp"
+#ifdef STP_COMPETITION
+#include "../CompetitionConfig.hpp"
+#endif
 
 
 namespace Skills {
@@ -23,6 +27,7 @@ namespace Skills {
 
 
 
+		///	note: overwritten while setting up if auto_target is set
 		Geometry2d::Point target;
 		
 		/** kick parameter flags */
@@ -31,6 +36,10 @@ namespace Skills {
 		bool kick_ready;
 		bool enable_kick;
 
+		///	aim at the most open part of the opponent's goal instead of target.  off by default, so
+		///	passes and clears go where the caller asked
+		bool auto_target;
+
 		// scale the kicking parameters to adjust speed/precision of the kick
 		float scaleSpeed;
 		float scaleAcc;
@@ -49,6 +58,50 @@ namespace Skills {
 		bool ballClose;
 
 
+		///	the tunables, read together once per update()
+		struct Params {
+			float driveAroundDist;
+			float setupToChargeThresh;
+			float escapeChargeThresh;
+			float setupBallAvoid;
+			float accelBias;
+			float facingThresh;
+			float maxSpeed;
+			float projTime;
+			float doneThresh;
+			float setupMoveTolerance;
+
+			///	cos(facingThresh), so update() doesn't take a cosine every frame
+			float cosFacingThresh;
+		};
+
+#ifdef STP_COMPETITION
+		///	the tuned values, baked in so the compiler can fold them
+		static Params params() {
+			Params p;
+			p.driveAroundDist = CompetitionConfig::LineKick::DriveAroundDist;
+			p.setupToChargeThresh = CompetitionConfig::LineKick::ChargeThresh;
+			p.escapeChargeThresh = CompetitionConfig::LineKick::EscapeChargeThresh;
+			p.setupBallAvoid = CompetitionConfig::LineKick::SetupBallAvoid;
+			p.accelBias = CompetitionConfig::LineKick::AccelBias;
+			p.facingThresh = CompetitionConfig::LineKick::FacingThreshDeg;
+			p.maxSpeed = CompetitionConfig::LineKick::MaxChargeSpeed;
+			p.projTime = CompetitionConfig::LineKick::BallProjectTime;
+			p.doneThresh = CompetitionConfig::LineKick::DoneStateThresh;
+			p.setupMoveTolerance = CompetitionConfig::LineKick::SetupMoveTolerance;
+			p.cosFacingThresh = cos(p.facingThresh * DegreesToRadians);
+			return p;
+		}
+#else
+		static Params params() {
+			return _params.read();
+		}
+
+		static void loadParams(Params &p);
+		static ConfigSnapshot<Params> _params;
+#endif
+
+
 
 		static ConfigDouble *_drive_around_dist;
 		static ConfigDouble *_setup_to_charge_thresh;
@@ -58,8 +111,8 @@ namespace Skills {
 		static ConfigDouble *_facing_thresh;
 		static ConfigDouble *_max_speed;
 		static ConfigDouble *_proj_time;
-		static ConfigDouble *_dampening;
 		static ConfigDouble *_done_thresh;
+		static ConfigDouble *_setup_move_tolerance;
 
 
 
@@ -3,6 +3,7 @@
 
 
 #include "../../STP.hpp"
+#include "../CommandBuffer.hpp"
 
 
 
@@ -15,6 +16,7 @@ namespace Skills {
 			Skill(gameplayModule, false, false)
 		{
 			stopAtEnd = true;
+			tolerance = 0.02;
 		}
 
 
@@ -34,8 +36,8 @@ namespace Skills {
 			if ( state() == ActionStateRunning ) {
 				OurRobot *r = robot();
 
-				r->move(target - (target - r->pos).normalized() * backoff, stopAtEnd);
-				r->face(face);
+				commands().moveWithin(target - (target - r->pos).normalized() * backoff, tolerance, stopAtEnd);
+				commands().face(face);
 
 				if ( isTargetReached() ) {
 					setState(ActionStateCompleted);
@@ -48,5 +50,8 @@ namespace Skills {
 		Geometry2d::Point face;
 		float backoff;
 		bool stopAtEnd;
+
+		///	changes to the target smaller than this don't make the robot replan its path
+		float tolerance;
 	};
 }
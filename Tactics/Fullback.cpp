@@ -2,9 +2,19 @@
 #include "Fullback.hpp"
 #include <gameplay/GameplayModule.hpp>
 #include "Goalie.hpp"
+#include "../World/WorldSnapshot.hpp"
+#include "../World/SpatialIndex.hpp"
+#include "../World/BallModel.hpp"
+#include "../World/OpponentPrediction.hpp"
+#include "../World/InterceptSolver.hpp"
+#include "../World/ShadowWindowEvaluator.hpp"
+#include "../World/MarkingAssignment.hpp"
+#include "../World/GeometryBatch.hpp"
+#include "../World/FieldModel.hpp"
+#include "../DebugChannel.hpp"
+#include "../CommandBuffer.hpp"
 
 #include <Constants.hpp>
-#include <gameplay/Window.hpp>
 #include <Geometry2d/util.h>
 
 #include <vector>
@@ -34,6 +44,13 @@ namespace Tactics {
 
 ConfigDouble *Tactics::Fullback::_defend_goal_radius;
 ConfigDouble *Tactics::Fullback::_opponent_avoid_threshold;
+ConfigDouble *Tactics::Fullback::_opponent_avoid_hysteresis;
+ConfigDouble *Tactics::Fullback::_move_tolerance;
+ConfigDouble *Tactics::Fullback::_intercept_min_ball_speed;
+
+#ifndef STP_COMPETITION
+ConfigSnapshot<Tactics::Fullback::Params> Tactics::Fullback::_params(&Tactics::Fullback::loadParams);
+#endif
 
 
 
@@ -43,26 +60,79 @@ void Tactics::Fullback::createConfiguration(Configuration *cfg)
 {
 	_defend_goal_radius = new ConfigDouble(cfg, "Fullback/Defend Goal Radius", 0.9);
 	_opponent_avoid_threshold = new ConfigDouble(cfg, "Fullback/Opponent Avoid Threshold", 2.0);
+	_opponent_avoid_hysteresis = new ConfigDouble(cfg, "Fullback/Opponent Avoid Hysteresis", 0.2);
+	_move_tolerance = new ConfigDouble(cfg, "Fullback/Move Tolerance", 0.03);
+	_intercept_min_ball_speed = new ConfigDouble(cfg, "Fullback/Intercept Min Ball Speed", 0.5);
 }
 
 
 
+#ifndef STP_COMPETITION
+void Tactics::Fullback::loadParams(Params &p)
+{
+	p.defendGoalRadius = *_defend_goal_radius;
+	p.opponentAvoidThreshold = *_opponent_avoid_threshold;
+	p.opponentAvoidHysteresis = *_opponent_avoid_hysteresis;
+	p.moveTolerance = *_move_tolerance;
+	p.interceptMinBallSpeed = *_intercept_min_ball_speed;
+}
+#endif
+
+
+
 OpponentRobot* Tactics::Fullback::findRobotToBlock(const Geometry2d::Rect& area)
 {
-	OpponentRobot* target = 0;
 	// Find by ball distance
-	BOOST_FOREACH(OpponentRobot* r, systemState()->opp)
+	SpatialIndex::Entry target;
+	if(!spatialIndex().nearest(ball().pos, SpatialIndex::KindThem, target, &area))
+		return 0;
+
+	return world().opponent(target.index);
+}
+
+
+
+Geometry2d::Rect Tactics::Fullback::area() const
+{
+	const Field &field = Field::instance();
+	if(side == Right && (_objectives & AreaMarking))
+		return field.rightHalf();
+	if(side == Left && (_objectives & AreaMarking))
+		return field.leftHalf();
+
+	return field.field();
+}
+
+
+
+const MarkingAssignment &Tactics::Fullback::markingAssignment()
+{
+	//	everyone in the registry with MultiMark set takes part
+	vector<MarkingAssignment::Defender> defenders;
+	BOOST_FOREACH(Fullback *f, _allFullbacks)
 	{
-		if(r && r->visible && area.contains(r->pos))
-		{
-			if(!target)
-				target = r;
-			else if(target->pos.distTo(ball().pos) > r->pos.distTo(ball().pos))
-				target = r;
-		}
+		if (f->robot() && (f->_objectives & MultiMark))
+			defenders.push_back(MarkingAssignment::Defender(f->robot(), f->area()));
 	}
 
-	return target;
+	return MarkingAssignment::forState(systemState(), defenders);
+}
+
+
+
+OpponentRobot* Tactics::Fullback::assignedRobotToBlock(const Geometry2d::Rect& area)
+{
+	if(!(_objectives & MultiMark))
+		return area.contains(ball().pos) ? 0 : findRobotToBlock(area);
+
+	// the team-wide assignment already chose between the ball and the opponents in our area
+	int target = markingAssignment().target(robot());
+	if(target >= 0)
+		return world().opponent(target);
+	if(target == MarkingAssignment::Ball)
+		return 0;
+
+	return area.contains(ball().pos) ? 0 : findRobotToBlock(area);
 }
 
 
@@ -76,27 +146,22 @@ void Tactics::Fullback::update() {
 
 	if ( state() != ActionStateRunning ) return;
 
+	const Params params = Tactics::Fullback::params();
+
 
 
 	if(blockRobot && !blockRobot->visible)
 	{
-		robot()->addText(QString("blockRobot Not visible!"));
+		DebugChannel::text(robot(), "blockRobot Not visible!");
 		blockRobot = 0;
 	}
 
-	Geometry2d::Rect area(Geometry2d::Point(-Field_Width/2.f, Field_Length), Geometry2d::Point(Field_Width/2.f, 0));
-	if(side == Right && (_objectives & AreaMarking))
-		area.pt[0].x = 0;
-	if(side == Left && (_objectives & AreaMarking))
-		area.pt[1].x = 0;
+	Geometry2d::Rect area = this->area();
 
 	// State changes
 	if(_subState == Marking)
 	{
-		if(area.contains(ball().pos))
-			blockRobot = 0;
-		else
-			blockRobot = findRobotToBlock(area);
+		blockRobot = assignedRobotToBlock(area);
 		// neither, defaults to blocking ball
 
 		if(_objectives & AreaMarking)
@@ -117,25 +182,46 @@ void Tactics::Fullback::update() {
 			}
 			else
 			{
-				blockRobot = findRobotToBlock(area);
+				blockRobot = assignedRobotToBlock(area);
 				if(blockRobot)
 					_subState = Marking;
 			}
 		}
 	}
 
+	// Intercept overrides the other states while we're the first of our robots to the ball's path
+	if(_objectives & Intercept)
+	{
+		const InterceptSolver &intercepts = interceptSolver();
+		int self = world().indexOf(robot());
+
+		//	a ball that's barely moving can point any way from noise, so it has to be coming at us
+		bool first = self >= 0 && intercepts.fastest() == self && intercepts.feasible(self);
+		bool incoming = ball().vel.y < -params.interceptMinBallSpeed;
+		if(first && incoming && intercepts.point(self).y < Field_Length / 2)
+		{
+			_subState = Intercept;
+		}
+		else if(_subState == Intercept)
+		{
+			_subState = Marking;
+		}
+	}
+
 
 
 
 
 
 	if(blockRobot)
-		robot()->addText(QString("Blocking Robot %1").arg(blockRobot->shell()));
+		DebugChannel::text(robot(), "Blocking Robot %1", blockRobot->shell());
 
 	if(_subState == AreaMarking)
-		robot()->addText(QString("AreaMarking"));
+		DebugChannel::text(robot(), "AreaMarking");
 	else if (_subState == Marking)
-		robot()->addText(QString("Marking"));
+		DebugChannel::text(robot(), "Marking");
+	else if (_subState == Intercept)
+		DebugChannel::text(robot(), "Intercept");
 
 
 
@@ -143,10 +229,13 @@ void Tactics::Fullback::update() {
 
 
 	// Do not avoid opponents when planning while we are close to the goal
-	if (robot()->pos.nearPoint(Geometry2d::Point(), *_opponent_avoid_threshold))
-		robot()->avoidOpponents(false);
-	else
-		robot()->avoidOpponents(true);
+	// the switch back happens a bit further out so hovering at the threshold doesn't flip it every frame
+	float goalDist = robot()->pos.distTo(Geometry2d::Point());
+	if (_avoidingOpponents && goalDist < params.opponentAvoidThreshold)
+		_avoidingOpponents = false;
+	else if (!_avoidingOpponents && goalDist > params.opponentAvoidThreshold + params.opponentAvoidHysteresis)
+		_avoidingOpponents = true;
+	commands().avoidOpponents(_avoidingOpponents);
 
 
 
@@ -165,16 +254,15 @@ void Tactics::Fullback::update() {
 		// also, this will be used for where the robots will face
 		if(blockRobot)
 		{
-			blockTargetFuture = blockRobot->pos + blockRobot->vel*0.3;
+			blockTargetFuture = opponentPrediction().pos(world().indexOf(blockRobot), OpponentPrediction::Horizon300ms);
 		}
 		else if(!blockRobot)
 		{
-			blockTargetFuture = ball().pos + ball().vel*0.3;
+			blockTargetFuture = ballModel().pos(0.3);
 		}
 
 		//goal line, for intersection detection
-		Geometry2d::Segment goalLine(Geometry2d::Point(-Field_GoalWidth / 2.0f, 0),
-									 Geometry2d::Point(Field_GoalWidth / 2.0f, 0));
+		const Geometry2d::Segment &goalLine = Field::instance().ourGoalLine();
 
 		//exclude robots that aren't the fullback
 		BOOST_FOREACH(Fullback *f, _allFullbacks)	//	FIXME: what does the above comment mean?
@@ -185,15 +273,14 @@ void Tactics::Fullback::update() {
 			}
 		}
 
-		_winEval.run(blockTargetFuture, goalLine);
+		_winEval.run(blockTargetFuture, goalLine, _windows);
 	}
 	else if(_subState == AreaMarking)
 	{
 		Geometry2d::Point goalTarget(0, -Field_GoalDepth/2.f);
 
 		//goal line, for intersection detection
-		Geometry2d::Segment goalLine = Geometry2d::Segment(Geometry2d::Point(-Field_GoalWidth / 2.0f, 0),
-														   Geometry2d::Point(Field_GoalWidth / 2.0f, 0));
+		Geometry2d::Segment goalLine = Field::instance().ourGoalLine();
 		if(side == Left)
 			goalLine.pt[1] = Geometry2d::Point(0,0);
 		if(side == Right)
@@ -211,12 +298,12 @@ void Tactics::Fullback::update() {
 		if(gameplayModule()->goalie())
 			_winEval.exclude.push_back(gameplayModule()->goalie()->robot()->pos);
 
-		_winEval.run(goalLine, goalTarget, Field_Length/2.f);
+		_winEval.run(goalLine, goalTarget, Field_Length/2.f, _windows);
 	}
 
 
 	// Pick best window
-	Window* best = 0;
+	ShadowWindow* best = 0;
 	
 	if(_subState == Marking)
 	{
@@ -224,7 +311,7 @@ void Tactics::Fullback::update() {
 		Tactics::Goalie* goalie = gameplayModule()->goalie();
 		if (goalie && goalie->robot() && side != Center)
 		{
-			BOOST_FOREACH(Window* window, _winEval.windows)
+			for (ShadowWindow* window = _windows.begin(); window != _windows.end(); ++window)
 			{
 				if (!best)
 					best = window;
@@ -243,24 +330,29 @@ void Tactics::Fullback::update() {
 		else
 		{
 			//if no side parameter...stay in the middle
-			float bestDist = 0;
-			BOOST_FOREACH(Window* window, _winEval.windows)
+			// distance from us to each line from a window's center to the ball, all at once
+			const int n = _windows.size();
+			float ax[ShadowWindowBuffer::Capacity], ay[ShadowWindowBuffer::Capacity];
+			float dist[ShadowWindowBuffer::Capacity];
+			for (int i = 0; i < n; i++)
 			{
-				Geometry2d::Segment seg(window->segment.center(), ball().pos);
-				float newDist = seg.distTo(robot()->pos);
+				Geometry2d::Point center = _windows[i].segment.center();
+				ax[i] = center.x;
+				ay[i] = center.y;
+			}
+			GeometryBatch::distToSegments(robot()->pos, ax, ay, ball().pos, n, dist);
 
-				if (!best || newDist < bestDist)
-				{
-					best = window;
-					bestDist = newDist;
-				}
+			for (int i = 0; i < n; i++)
+			{
+				if (!best || dist[i] < dist[best - _windows.begin()])
+					best = &_windows[i];
 			}
 		}
 	}
 	else if(_subState == AreaMarking)
 	{
 		float angle;
-		BOOST_FOREACH(Window* window, _winEval.windows)
+		for (ShadowWindow* window = _windows.begin(); window != _windows.end(); ++window)
 		{
 			if(!best){
 				best = window;
@@ -284,7 +376,7 @@ void Tactics::Fullback::update() {
 		{
 			if(blockRobot)
 			{
-				Geometry2d::Point dir = Geometry2d::Point::direction(blockRobot->angle * DegreesToRadians);
+				Geometry2d::Point dir = world().them.heading(world().indexOf(blockRobot));
 				shootLine = Geometry2d::Segment(blockRobot->pos, blockRobot->pos + dir* 7.0);
 			}
 			else if(!blockRobot)
@@ -296,7 +388,7 @@ void Tactics::Fullback::update() {
 		{
 			float angle = (best->a0 + best->a1) / 2.f;
 			shootLine = Geometry2d::Segment(_winEval.origin(), Geometry2d::Point::direction(angle * DegreesToRadians));
-			systemState()->drawLine(shootLine, QColor(255,0,0));
+			DebugChannel::line(shootLine, DebugChannel::rgb(255, 0, 0));
 		}
 	}
 
@@ -311,8 +403,8 @@ void Tactics::Fullback::update() {
 		{
 			if (ball().vel.magsq() > 0.03 && winSeg.intersects(shootLine))
 			{
-				robot()->move(shootLine.nearestPoint(robot()->pos));
-				robot()->faceNone();
+				commands().move(shootLine.nearestPoint(robot()->pos));
+				commands().faceNone();
 			}
 			else
 			{
@@ -324,7 +416,7 @@ void Tactics::Fullback::update() {
 				}
 				else
 				{
-					Geometry2d::Circle arc(Geometry2d::Point(), *_defend_goal_radius);
+					Geometry2d::Circle arc(Geometry2d::Point(), params.defendGoalRadius);
 					Geometry2d::Line shot(winSeg.center(), blockTargetFuture);
 					Geometry2d::Point dest[2];
 
@@ -332,15 +424,15 @@ void Tactics::Fullback::update() {
 
 					if (intersected)
 					{
-						robot()->move(dest[0].y > 0 ? dest[0] : dest[1]);
+						commands().moveWithin(dest[0].y > 0 ? dest[0] : dest[1], params.moveTolerance);
 
 						// Using regular pos rather than future because velocity approx on ball is not exact
 						// enough and this leads to the robots turning backwards, towards the goal, when the
 						// ball is shot at the goal.
 						if(blockRobot)
-							robot()->face(blockRobot->pos);
+							commands().face(blockRobot->pos);
 						else if(!blockRobot)
-							robot()->face(ball().pos);
+							commands().face(ball().pos);
 					}
 					else
 					{
@@ -351,7 +443,7 @@ void Tactics::Fullback::update() {
 		}
 		else if(_subState == AreaMarking)
 		{
-			Geometry2d::Circle arc(Geometry2d::Point(), *_defend_goal_radius);
+			Geometry2d::Circle arc(Geometry2d::Point(), params.defendGoalRadius);
 			Geometry2d::Line shot(shootLine.pt[0],shootLine.pt[1]);
 			Geometry2d::Point dest[2];
 
@@ -359,7 +451,7 @@ void Tactics::Fullback::update() {
 
 			if (intersected)
 			{
-				robot()->move((dest[0].y > 0 ? dest[0] : dest[1]));
+				commands().moveWithin((dest[0].y > 0 ? dest[0] : dest[1]), params.moveTolerance);
 			}
 			else
 			{
@@ -367,6 +459,12 @@ void Tactics::Fullback::update() {
 			}
 		}
 	}
+	else if(_subState == Intercept)
+	{
+		// get to where the ball will be and meet it head on
+		commands().move(interceptSolver().point(world().indexOf(robot())));
+		commands().face(ball().pos);
+	}
 	else
 	{
 		needTask = true;
@@ -375,13 +473,13 @@ void Tactics::Fullback::update() {
 	// if needTask, face the ball
 	if(needTask)
 	{
-		robot()->face(ball().pos, true);
+		commands().face(ball().pos, true);
 	}
 
 	// Turn dribbler on when ball is near
 	if(ball().pos.y < Field_Length / 2)
 	{
-		robot()->dribble(255);
+		commands().dribble(255);
 	}
 
 	// If ball sensor is tripped and we are not facing towards the goal, fire.
@@ -395,9 +493,9 @@ void Tactics::Fullback::update() {
 	if(!facingBackLine)
 	{
 		if(robot()->chipper_available())
-			robot()->chip(255);
+			commands().chip(255);
 		else
-			robot()->kick(255);
+			commands().kick(255);
 	}
 }
 
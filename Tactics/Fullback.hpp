@@ -3,7 +3,13 @@
 
 #include "../../STP.hpp"
 #include "Configuration.hpp"
-#include "../../gameplay/Window.hpp"
+#include "../ConfigSnapshot.hpp"
+#ifdef STP_COMPETITION
+#include "../CompetitionConfig.hpp"
+#endif
+#include "../World/ShadowWindowEvaluator.hpp"
+
+class MarkingAssignment;
 
 
 namespace Tactics {
@@ -42,7 +48,8 @@ namespace Tactics {
 		{
 			_subState = Marking;
 			_winEval.debug = false;
-			_objectives = Marking;
+			_objectives = Marking | MultiMark;
+			_avoidingOpponents = true;
 			side = Center;
 
 			//	add to global Fullback registry
@@ -62,6 +69,17 @@ namespace Tactics {
 			
 		}
 
+
+		///	bitmask of Objectives this fullback may pursue.  Intercept is off unless a play turns it on,
+		///	and then it only takes over while we're the first robot to a ball coming at our half.
+		int objectives() const {
+			return _objectives;
+		}
+
+		void setObjectives(int objectives) {
+			_objectives = objectives;
+		}
+
 	
 		//	we'd prefer to have a robot that's already close to the target point
 		virtual void setPreferencesForRole(Role *role) {
@@ -89,15 +107,60 @@ namespace Tactics {
 
 
 	private:
-		Gameplay::WindowEvaluator _winEval;
+		ShadowWindowEvaluator _winEval;
+		ShadowWindowBuffer _windows;
 		int _objectives;
 		Objective _subState;
 
+		///	whether we're avoiding opponents, which switches with some hysteresis around the threshold
+		bool _avoidingOpponents;
+
+		///	the tunables, read together once per update()
+		struct Params {
+			float defendGoalRadius;
+			float opponentAvoidThreshold;
+			float opponentAvoidHysteresis;
+			float moveTolerance;
+			float interceptMinBallSpeed;
+		};
+
+#ifdef STP_COMPETITION
+		///	the tuned values, baked in so the compiler can fold them
+		static Params params() {
+			Params p;
+			p.defendGoalRadius = CompetitionConfig::Fullback::DefendGoalRadius;
+			p.opponentAvoidThreshold = CompetitionConfig::Fullback::OpponentAvoidThreshold;
+			p.opponentAvoidHysteresis = CompetitionConfig::Fullback::OpponentAvoidHysteresis;
+			p.moveTolerance = CompetitionConfig::Fullback::MoveTolerance;
+			p.interceptMinBallSpeed = CompetitionConfig::Fullback::InterceptMinBallSpeed;
+			return p;
+		}
+#else
+		static Params params() {
+			return _params.read();
+		}
+
+		static void loadParams(Params &p);
+		static ConfigSnapshot<Params> _params;
+#endif
+
 		static ConfigDouble *_defend_goal_radius;
 		static ConfigDouble *_opponent_avoid_threshold;
+		static ConfigDouble *_opponent_avoid_hysteresis;
+		static ConfigDouble *_move_tolerance;
+		static ConfigDouble *_intercept_min_ball_speed;
 
 		OpponentRobot* findRobotToBlock(const Geometry2d::Rect& area);
 
+		///	the opponent to mark, or NULL to block the ball.  With MultiMark set this comes from
+		///	the team-wide MarkingAssignment, otherwise from findRobotToBlock().
+		OpponentRobot* assignedRobotToBlock(const Geometry2d::Rect& area);
+
+		///	the part of the field this fullback is responsible for
+		Geometry2d::Rect area() const;
+
+		const MarkingAssignment &markingAssignment();
+
 
 		static std::vector<Fullback *> _allFullbacks;
 	};
@@ -3,6 +3,7 @@
 
 
 #include "../../STP.hpp"
+#include "../CommandBuffer.hpp"
 
 
 namespace Tactics {
@@ -17,7 +18,7 @@ namespace Tactics {
 			}
 
 			if ( state() == ActionStateRunning ) {
-				robot()->stop();
+				commands().stop();
 			}
 		}
 
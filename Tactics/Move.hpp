@@ -3,6 +3,8 @@
 
 #include "../../STP.hpp"
 #include "../Skills/Move.hpp"
+#include "../World/InterceptSolver.hpp"
+#include "../World/MotionModel.hpp"
 
 
 namespace Tactics {
@@ -50,6 +52,26 @@ namespace Tactics {
 			role->setPreferredInitialPosition(target);
 		}
 
+		virtual bool preferredInitialPosition(Geometry2d::Point &pt) const {
+			pt = target;
+			return true;
+		}
+
+		static bool initialPositionFromParameters(ValueTree *params, Geometry2d::Point &pt) {
+			if ( !params ) return false;
+
+			pt.x = params->get<float>("target.x");
+			pt.y = params->get<float>("target.y");
+			return true;
+		}
+
+		virtual float timeRemaining() {
+			OurRobot *r = robot();
+			if ( !r ) return -1;
+
+			return MotionModel::travelTime(r->pos.distTo(target), 0, InterceptSolver::maxAccel(), InterceptSolver::maxSpeed());
+		}
+
 
 
 		static RobotRequirements robotRequirements;
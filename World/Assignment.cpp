@@ -0,0 +1,88 @@
+
+#include "Assignment.hpp"
+
+#include <limits>
+#include <string>
+
+using namespace std;
+
+
+
+const float Assignment::Forbidden = 1e6;
+
+
+
+float Assignment::solve(const float *cost, int rows, int cols, int *rowToCol, bool warmStart) {
+	if ( rows > cols ) {
+		throw string("ERROR: Assignment::solve() needs at least as many columns as rows");
+	}
+
+	const float inf = numeric_limits<float>::max();
+
+	//	Row potentials are set as each row is added, so only the columns carry over.  With spare
+	//	columns, the unmatched ones must end with a zero potential, which old potentials break.
+	_u.assign(rows + 1, 0);
+	if ( !warmStart || rows != cols || _v.size() != cols + 1 ) _v.assign(cols + 1, 0);
+	_match.assign(cols + 1, 0);
+	_way.assign(cols + 1, 0);
+	_minv.resize(cols + 1);
+	_used.resize(cols + 1);
+
+	//	add rows one at a time, each time finding the shortest augmenting path
+	//	from the new row with respect to the reduced costs
+	for ( int i = 1; i <= rows; i++ ) {
+		_match[0] = i;
+		int j0 = 0;
+		_minv.assign(cols + 1, inf);
+		_used.assign(cols + 1, 0);
+
+		do {
+			_used[j0] = 1;
+			int i0 = _match[j0];
+			int j1 = 0;
+			float delta = inf;
+
+			for ( int j = 1; j <= cols; j++ ) {
+				if ( _used[j] ) continue;
+
+				float cur = cost[(i0 - 1) * cols + (j - 1)] - _u[i0] - _v[j];
+				if ( cur < _minv[j] ) {
+					_minv[j] = cur;
+					_way[j] = j0;
+				}
+				if ( _minv[j] < delta ) {
+					delta = _minv[j];
+					j1 = j;
+				}
+			}
+
+			for ( int j = 0; j <= cols; j++ ) {
+				if ( _used[j] ) {
+					_u[_match[j]] += delta;
+					_v[j] -= delta;
+				} else {
+					_minv[j] -= delta;
+				}
+			}
+
+			j0 = j1;
+		} while ( _match[j0] != 0 );
+
+		//	flip the augmenting path
+		do {
+			int j1 = _way[j0];
+			_match[j0] = _match[j1];
+			j0 = j1;
+		} while ( j0 );
+	}
+
+	float total = 0;
+	for ( int j = 1; j <= cols; j++ ) {
+		if ( _match[j] ) {
+			rowToCol[_match[j] - 1] = j - 1;
+			total += cost[(_match[j] - 1) * cols + (j - 1)];
+		}
+	}
+
+	return total;
+}
@@ -0,0 +1,42 @@
+
+#pragma once
+
+#include <vector>
+
+
+/**
+ *	Minimum-cost bipartite assignment (the Hungarian algorithm).
+ *
+ *	Assigns each row to a distinct column so that the sum of the chosen costs is as small as
+ *	possible.  Runs in O(rows^2 * cols), which is nothing for a handful of robots.  There must be
+ *	at least as many columns as rows - pad with dummy columns if needed.
+ *
+ *	Keep one Assignment around and call solve() every frame so its work arrays are reused.
+ *	Costs of Forbidden and above mean "never"; check the chosen costs if that can happen.
+ */
+class Assignment {
+public:
+	///	use this cost for pairings that must not be chosen unless there's no other way
+	static const float Forbidden;
+
+
+	///	@cost is row-major, rows x cols.  @rowToCol receives the column chosen for each row.
+	///	Returns the total cost of the assignment.
+	///
+	///	With @warmStart set and a square matrix, the column potentials left by the previous solve
+	///	are reused as the starting duals, which saves work when the columns mean the same thing as
+	///	last time and the costs only changed a little.  Any starting duals give an optimal answer
+	///	when every column gets matched.  Non-square problems always start cold, so pad them with
+	///	zero-cost dummy rows to get warm starts.
+	float solve(const float *cost, int rows, int cols, int *rowToCol, bool warmStart = false);
+
+
+private:
+	//	potentials, matching, and scratch, 1-indexed as in the textbook formulation
+	std::vector<float> _u;
+	std::vector<float> _v;
+	std::vector<int> _match;
+	std::vector<int> _way;
+	std::vector<float> _minv;
+	std::vector<char> _used;
+};
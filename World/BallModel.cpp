@@ -0,0 +1,154 @@
+
+#include "BallModel.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace Geometry2d;
+
+
+
+REGISTER_CONFIGURABLE(BallModel)
+
+ConfigDouble *BallModel::_rolling_deceleration;
+ConfigDouble *BallModel::_fit_rate;
+ConfigDouble *BallModel::_min_fit_speed;
+
+
+const float BallModel::SampleTime = 1.0 / 60.0;
+const float BallModel::MaxHorizon = 5.0;
+
+PerFrame<BallModel> BallModel::_current;
+
+
+//	deceleration is clamped to this range, whether configured or fitted, so a bad frame or config
+//	value can't wreck the model
+static const float MinDecel = 0.05;
+static const float MaxDecel = 3.0;
+
+
+
+void BallModel::createConfiguration(Configuration *cfg)
+{
+	_rolling_deceleration = new ConfigDouble(cfg, "BallModel/Rolling Deceleration", 0.4);
+	_fit_rate = new ConfigDouble(cfg, "BallModel/Fit Rate", 0.05);
+	_min_fit_speed = new ConfigDouble(cfg, "BallModel/Min Fit Speed", 0.3);
+}
+
+
+
+BallModel::BallModel() {
+	_speed = 0;
+	_decel = 0;
+	_stopTime = 0;
+	_havePrevious = false;
+	_prevTimestamp = 0;
+	_samples.reserve((int)(MaxHorizon / SampleTime) + 2);
+}
+
+
+
+const BallModel &BallModel::forState(SystemState *state) {
+	return _current.get(state, &BallModel::update);
+}
+
+
+
+void BallModel::fitDeceleration(SystemState *state) {
+	if ( _decel <= 0 ) _decel = max(MinDecel, min(MaxDecel, (float)*_rolling_deceleration));
+
+	const Point &vel = state->ball.vel;
+
+	if ( _havePrevious && state->timestamp > _prevTimestamp ) {
+		//	timestamps are in microseconds
+		float dt = (state->timestamp - _prevTimestamp) * 1.0e-6f;
+		float prevSpeed = _prevVel.mag();
+		float speed = vel.mag();
+
+		//	only fit while the ball is rolling freely: fast enough to measure, slowing down,
+		//	and still going the same way (so it wasn't kicked or deflected)
+		bool rolling = prevSpeed > *_min_fit_speed && speed > *_min_fit_speed &&
+					   speed < prevSpeed && _prevVel.dot(vel) > 0.95f * prevSpeed * speed;
+
+		if ( rolling && dt > 0 && dt < 0.1f ) {
+			float measured = (prevSpeed - speed) / dt;
+			if ( measured < MaxDecel ) {
+				_decel += *_fit_rate * (measured - _decel);
+				_decel = max(MinDecel, min(MaxDecel, _decel));
+			}
+		}
+	}
+
+	_havePrevious = true;
+	_prevTimestamp = state->timestamp;
+	_prevVel = vel;
+}
+
+
+
+void BallModel::update(SystemState *state) {
+	fitDeceleration(state);
+
+	_pos = state->ball.pos;
+	_speed = state->ball.vel.mag();
+	_dir = _speed > 0 ? state->ball.vel / _speed : Point();
+	_stopTime = _speed / _decel;
+
+	//	sample the trajectory
+	_samples.clear();
+	float horizon = min(_stopTime, MaxHorizon);
+	for ( float t = 0; t < horizon; t += SampleTime ) {
+		Sample s;
+		s.t = t;
+		s.pos = pos(t);
+		_samples.push_back(s);
+	}
+	Sample last;
+	last.t = horizon;
+	last.pos = pos(horizon);
+	_samples.push_back(last);
+}
+
+
+
+float BallModel::distanceAt(float t) const {
+	t = max(0.0f, min(t, _stopTime));
+	return _speed * t - 0.5f * _decel * t * t;
+}
+
+
+
+Point BallModel::pos(float t) const {
+	return _pos + _dir * distanceAt(t);
+}
+
+
+
+Point BallModel::vel(float t) const {
+	if ( t >= _stopTime ) return Point();
+	return _dir * (_speed - _decel * max(0.0f, t));
+}
+
+
+
+float BallModel::timeToLine(const Line &line) const {
+	Point delta = line.delta();
+	Point normal = delta.perpCCW();
+
+	//	signed distance from the ball to the line and closing rate along the direction of travel
+	float offset = normal.dot(line.pt[0] - _pos);
+	float closing = normal.dot(_dir);
+
+	if ( fabs(offset) < 1e-6f * normal.mag() ) return 0;
+	if ( closing == 0 || offset / closing < 0 ) return -1;
+
+	//	distance the ball has to roll to reach the line
+	float s = offset / closing;
+	float stopDist = distanceAt(_stopTime);
+	if ( s > stopDist ) return -1;
+
+	//	solve s = v t - a t^2 / 2 for the earlier root
+	float disc = max(0.0f, _speed * _speed - 2 * _decel * s);
+	return (_speed - sqrt(disc)) / _decel;
+}
@@ -0,0 +1,119 @@
+
+#pragma once
+
+#include "Configuration.hpp"
+#include "PerFrame.hpp"
+
+#include <framework/SystemState.hpp>
+#include <Geometry2d/Point.hpp>
+#include <Geometry2d/Line.hpp>
+
+#include <vector>
+#include <stdint.h>
+
+
+/**
+ *	Prediction of where the ball is going, shared by every Action for the frame.
+ *
+ *	The ball is modeled as rolling in a straight line with constant deceleration from
+ *	friction.  The deceleration starts at a configured value and is refined online from
+ *	the change in ball speed between frames while the ball is rolling freely.
+ *
+ *	Position, velocity and time-to-line queries are closed form.  The trajectory is also
+ *	sampled at a fixed interval for consumers that want to walk it.
+ */
+class BallModel {
+public:
+	static void createConfiguration(Configuration *cfg);
+
+
+	///	spacing of the precomputed trajectory samples in seconds
+	static const float SampleTime;
+
+	///	the sampled trajectory doesn't extend past this many seconds
+	static const float MaxHorizon;
+
+
+	class Sample {
+	public:
+		float t;
+		Geometry2d::Point pos;
+	};
+
+
+	BallModel();
+
+
+	///	returns the model for the current frame, updating it if this is the first call of the frame
+	static const BallModel &forState(SystemState *state);
+
+
+	///	refits the deceleration and rebuilds the trajectory from the ball in @state
+	void update(SystemState *state);
+
+
+	///	predicted ball position @t seconds from now
+	Geometry2d::Point pos(float t) const;
+
+	///	predicted ball velocity @t seconds from now
+	Geometry2d::Point vel(float t) const;
+
+
+	///	seconds until the ball stops rolling
+	float stopTime() const {
+		return _stopTime;
+	}
+
+	///	where the ball will come to rest
+	Geometry2d::Point stopPoint() const {
+		return pos(_stopTime);
+	}
+
+
+	///	Seconds until the ball crosses @line, or -1 if it stops first or is moving away from it.
+	///	note: returns 0 if the ball is stationary on the line
+	float timeToLine(const Geometry2d::Line &line) const;
+
+
+	///	distance the ball rolls in the first @t seconds
+	float distanceAt(float t) const;
+
+
+	///	samples from now until the ball stops, or MaxHorizon, whichever comes first
+	const std::vector<Sample> &samples() const {
+		return _samples;
+	}
+
+
+	///	currently fitted rolling deceleration in m/s^2
+	float deceleration() const {
+		return _decel;
+	}
+
+
+private:
+	void fitDeceleration(SystemState *state);
+
+
+	Geometry2d::Point _pos;
+
+	///	unit vector in the direction of travel
+	Geometry2d::Point _dir;
+	float _speed;
+	float _decel;
+	float _stopTime;
+
+	std::vector<Sample> _samples;
+
+	//	previous frame, for fitting the deceleration
+	bool _havePrevious;
+	uint64_t _prevTimestamp;
+	Geometry2d::Point _prevVel;
+
+
+	static ConfigDouble *_rolling_deceleration;
+	static ConfigDouble *_fit_rate;
+	static ConfigDouble *_min_fit_speed;
+
+	static PerFrame<BallModel> _current;
+};
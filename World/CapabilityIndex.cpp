@@ -0,0 +1,57 @@
+
+#include "CapabilityIndex.hpp"
+
+
+
+PerFrame<CapabilityIndex> CapabilityIndex::_current;
+
+
+
+CapabilityIndex::CapabilityIndex() {
+	_visible = 0;
+	_kicker = 0;
+	_chipper = 0;
+	_dribbler = 0;
+	_generation = 0;
+}
+
+
+
+const CapabilityIndex &CapabilityIndex::forState(SystemState *state) {
+	return _current.get(state, &CapabilityIndex::update);
+}
+
+
+
+void CapabilityIndex::update(const WorldSnapshot &world) {
+	uint32_t kicker = 0;
+	uint32_t chipper = 0;
+	uint32_t dribbler = 0;
+
+	for ( int i = 0; i < world.us.count; i++ ) {
+		OurRobot *r = world.ourRobot(i);
+		if ( !r ) continue;
+
+		if ( r->kicker_available() ) kicker |= 1u << i;
+		if ( r->chipper_available() ) chipper |= 1u << i;
+		if ( r->dribbler_available() ) dribbler |= 1u << i;
+	}
+
+	if ( world.us.visible != _visible || kicker != _kicker || chipper != _chipper || dribbler != _dribbler ) {
+		_visible = world.us.visible;
+		_kicker = kicker;
+		_chipper = chipper;
+		_dribbler = dribbler;
+		_generation++;
+	}
+}
+
+
+
+int CapabilityIndex::count(RobotRequirements requirements) const {
+	uint32_t robots = satisfying(requirements);
+
+	int n = 0;
+	for ( ; robots; n++ ) robots &= robots - 1;
+	return n;
+}
@@ -0,0 +1,76 @@
+
+#pragma once
+
+#include "WorldSnapshot.hpp"
+
+#include "Role.hpp"
+#include "PerFrame.hpp"
+
+
+/**
+ *	Which of our robots can currently kick, chip and dribble, as one bitset per capability.
+ *
+ *	Bit i of each set refers to WorldSnapshot::us index i.  The hardware status is read once per
+ *	frame, so checking whether robots satisfy a RobotRequirements mask is a few ANDs instead of
+ *	a call per robot per capability.  generation() changes whenever any bit does, so callers can
+ *	keep derived results until the hardware status actually changes.
+ */
+class CapabilityIndex {
+public:
+	CapabilityIndex();
+
+
+	///	returns the index for the current frame, refreshing it if this is the first call of the frame
+	static const CapabilityIndex &forState(SystemState *state);
+
+
+	void update(const WorldSnapshot &world);
+
+
+	///	visible robots that have everything in @requirements
+	uint32_t satisfying(RobotRequirements requirements) const {
+		uint32_t robots = _visible;
+		if ( requirements & RobotRequirementKicker ) robots &= _kicker;
+		if ( requirements & RobotRequirementChipper ) robots &= _chipper;
+		if ( requirements & RobotRequirementDribbler ) robots &= _dribbler;
+		return robots;
+	}
+
+	///	true if robot @i is visible and has everything in @requirements
+	bool satisfies(int i, RobotRequirements requirements) const {
+		return i >= 0 && ((satisfying(requirements) >> i) & 1);
+	}
+
+	///	number of visible robots that have everything in @requirements
+	int count(RobotRequirements requirements) const;
+
+
+	uint32_t kicker() const {
+		return _kicker;
+	}
+
+	uint32_t chipper() const {
+		return _chipper;
+	}
+
+	uint32_t dribbler() const {
+		return _dribbler;
+	}
+
+
+	///	incremented every time a bit changes
+	int generation() const {
+		return _generation;
+	}
+
+
+private:
+	uint32_t _visible;
+	uint32_t _kicker;
+	uint32_t _chipper;
+	uint32_t _dribbler;
+	int _generation;
+
+
+	static PerFrame<CapabilityIndex> _current;
+};
@@ -0,0 +1,103 @@
+
+#pragma once
+
+#include <Constants.hpp>
+#include <Geometry2d/Point.hpp>
+#include <Geometry2d/Rect.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+
+/**
+ *	Maps between field coordinates and the cells of a regular raster covering the field.
+ *
+ *	The raster spans the field lines exactly: cell (0, 0) is at our goal line on the left.
+ *	Cells are numbered row-major, so index = y * cols + x.
+ */
+class FieldGrid {
+public:
+	FieldGrid() {
+		resize(0.25);
+	}
+
+	FieldGrid(float cellSize) {
+		resize(cellSize);
+	}
+
+
+	void resize(float cellSize) {
+		_cellSize = cellSize;
+		_cols = std::max(1, (int)ceil(Field_Width / cellSize));
+		_rows = std::max(1, (int)ceil(Field_Length / cellSize));
+		_minX = -Field_Width / 2;
+	}
+
+
+	float cellSize() const {
+		return _cellSize;
+	}
+
+	int cols() const {
+		return _cols;
+	}
+
+	int rows() const {
+		return _rows;
+	}
+
+	int size() const {
+		return _cols * _rows;
+	}
+
+
+	///	column of the cell containing @x, clamped to the raster
+	int col(float x) const {
+		return std::max(0, std::min(_cols - 1, (int)floor((x - _minX) / _cellSize)));
+	}
+
+	///	row of the cell containing @y, clamped to the raster
+	int row(float y) const {
+		return std::max(0, std::min(_rows - 1, (int)floor(y / _cellSize)));
+	}
+
+	int index(int col, int row) const {
+		return row * _cols + col;
+	}
+
+	int index(const Geometry2d::Point &pt) const {
+		return index(col(pt.x), row(pt.y));
+	}
+
+
+	Geometry2d::Point center(int col, int row) const {
+		return Geometry2d::Point(_minX + (col + 0.5f) * _cellSize, (row + 0.5f) * _cellSize);
+	}
+
+	Geometry2d::Point center(int index) const {
+		return center(index % _cols, index / _cols);
+	}
+
+
+	///	inclusive range of the cells whose centers are in @region, false if there are none
+	bool cellRange(const Geometry2d::Rect &region, int &c0, int &r0, int &c1, int &r1) const {
+		float x0 = std::min(region.pt[0].x, region.pt[1].x);
+		float x1 = std::max(region.pt[0].x, region.pt[1].x);
+		float y0 = std::min(region.pt[0].y, region.pt[1].y);
+		float y1 = std::max(region.pt[0].y, region.pt[1].y);
+
+		c0 = std::max(0, (int)ceil((x0 - _minX) / _cellSize - 0.5f));
+		c1 = std::min(_cols - 1, (int)floor((x1 - _minX) / _cellSize - 0.5f));
+		r0 = std::max(0, (int)ceil(y0 / _cellSize - 0.5f));
+		r1 = std::min(_rows - 1, (int)floor(y1 / _cellSize - 0.5f));
+
+		return c0 <= c1 && r0 <= r1;
+	}
+
+
+private:
+	float _cellSize;
+	int _cols;
+	int _rows;
+	float _minX;
+};
@@ -0,0 +1,239 @@
+
+#pragma once
+
+#include <Constants.hpp>
+#include <Geometry2d/Point.hpp>
+#include <Geometry2d/Segment.hpp>
+#include <Geometry2d/Rect.hpp>
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+
+///	field dimensions of the division we're built for, straight from Constants.hpp
+class ConstantsFieldDims {
+public:
+	static float length()		{ return Field_Length; }
+	static float width()		{ return Field_Width; }
+	static float goalWidth()	{ return Field_GoalWidth; }
+	static float goalDepth()	{ return Field_GoalDepth; }
+	static float arcRadius()	{ return Field_ArcRadius; }
+	static float goalFlat()		{ return Field_GoalFlat; }
+};
+
+
+
+/**
+ *	Fixed geometry of the field: goal mouths, edges, halves and defense areas, built once from
+ *	a set of dimensions instead of being rebuilt by every Action every frame.
+ *
+ *	@Dims supplies the dimensions as static functions, the way ConstantsFieldDims does.  A
+ *	division with a different field gets its own dims class and its own FieldModel.  Code that
+ *	doesn't care which division it is uses the Field typedef.
+ *
+ *	Besides the exact shapes, a coarse table over the field classifies points into thirds,
+ *	sides, halves and defense areas, and gives the distance to the nearest field line, all with
+ *	one lookup.  Table answers are exact at cell centers.  Near a boundary they can be off by
+ *	up to half a cell (TableResolution / 2), so use the exact tests when that matters.
+ *
+ *	Coordinates are the usual ones: our goal is centered at the origin, theirs at (0, length),
+ *	and "left" is -x.
+ */
+template<class Dims>
+class FieldModel {
+public:
+	typedef enum {
+		ThirdDefense,
+		ThirdMidfield,
+		ThirdAttack
+	} Third;
+
+	typedef enum {
+		SideLeft,
+		SideCenter,
+		SideRight
+	} Side;
+
+	///	bits returned by flags()
+	typedef enum {
+		FlagOurHalf				= 1,
+		FlagOurDefenseArea		= 2,
+		FlagTheirDefenseArea	= 4,
+		FlagInField				= 8
+	} Flag;
+
+
+	///	size of the lookup table cells, in meters
+	static float tableResolution() {
+		return 0.05f;
+	}
+
+
+	static const FieldModel &instance() {
+		static FieldModel model;
+		return model;
+	}
+
+
+	float length() const { return Dims::length(); }
+	float width() const { return Dims::width(); }
+
+
+	Geometry2d::Point ourGoal() const { return Geometry2d::Point(0, 0); }
+	Geometry2d::Point theirGoal() const { return Geometry2d::Point(0, Dims::length()); }
+
+	///	goal mouths, left post first
+	const Geometry2d::Segment &ourGoalLine() const { return _ourGoalLine; }
+	const Geometry2d::Segment &theirGoalLine() const { return _theirGoalLine; }
+
+	///	side lines, from our end to theirs
+	const Geometry2d::Segment &leftEdge() const { return _leftEdge; }
+	const Geometry2d::Segment &rightEdge() const { return _rightEdge; }
+
+	const Geometry2d::Segment &ourEndLine() const { return _ourEndLine; }
+	const Geometry2d::Segment &theirEndLine() const { return _theirEndLine; }
+	const Geometry2d::Segment &halfwayLine() const { return _halfwayLine; }
+
+	const Geometry2d::Rect &field() const { return _field; }
+	const Geometry2d::Rect &ourHalf() const { return _ourHalf; }
+	const Geometry2d::Rect &theirHalf() const { return _theirHalf; }
+	const Geometry2d::Rect &leftHalf() const { return _leftHalf; }
+	const Geometry2d::Rect &rightHalf() const { return _rightHalf; }
+
+
+	//	exact tests
+
+	bool inField(const Geometry2d::Point &pt) const {
+		return std::fabs(pt.x) <= Dims::width() / 2 && pt.y >= 0 && pt.y <= Dims::length();
+	}
+
+	///	within the arc radius of the flat part in front of our goal
+	bool inOurDefenseArea(const Geometry2d::Point &pt) const {
+		return pt.y >= 0 && distToFlat(pt.x, pt.y) <= Dims::arcRadius();
+	}
+
+	bool inTheirDefenseArea(const Geometry2d::Point &pt) const {
+		return pt.y <= Dims::length() && distToFlat(pt.x, Dims::length() - pt.y) <= Dims::arcRadius();
+	}
+
+
+	//	table lookups
+
+	Third third(const Geometry2d::Point &pt) const {
+		return (Third)(_table[cell(pt)] & 3);
+	}
+
+	Side side(const Geometry2d::Point &pt) const {
+		return (Side)((_table[cell(pt)] >> 2) & 3);
+	}
+
+	///	OR of Flag values
+	int flags(const Geometry2d::Point &pt) const {
+		return _table[cell(pt)] >> 4;
+	}
+
+	///	distance in meters to the closest side line or end line, clamped to the field
+	float edgeDistance(const Geometry2d::Point &pt) const {
+		return _edgeDistance[cell(pt)] * 0.001f;
+	}
+
+
+private:
+	FieldModel() {
+		const float l = Dims::length();
+		const float w = Dims::width();
+		const float g = Dims::goalWidth();
+
+		_ourGoalLine = Geometry2d::Segment(Geometry2d::Point(-g / 2, 0), Geometry2d::Point(g / 2, 0));
+		_theirGoalLine = Geometry2d::Segment(Geometry2d::Point(-g / 2, l), Geometry2d::Point(g / 2, l));
+		_leftEdge = Geometry2d::Segment(Geometry2d::Point(-w / 2, 0), Geometry2d::Point(-w / 2, l));
+		_rightEdge = Geometry2d::Segment(Geometry2d::Point(w / 2, 0), Geometry2d::Point(w / 2, l));
+		_ourEndLine = Geometry2d::Segment(Geometry2d::Point(-w / 2, 0), Geometry2d::Point(w / 2, 0));
+		_theirEndLine = Geometry2d::Segment(Geometry2d::Point(-w / 2, l), Geometry2d::Point(w / 2, l));
+		_halfwayLine = Geometry2d::Segment(Geometry2d::Point(-w / 2, l / 2), Geometry2d::Point(w / 2, l / 2));
+
+		_field = Geometry2d::Rect(Geometry2d::Point(-w / 2, l), Geometry2d::Point(w / 2, 0));
+		_ourHalf = Geometry2d::Rect(Geometry2d::Point(-w / 2, l / 2), Geometry2d::Point(w / 2, 0));
+		_theirHalf = Geometry2d::Rect(Geometry2d::Point(-w / 2, l), Geometry2d::Point(w / 2, l / 2));
+		_leftHalf = Geometry2d::Rect(Geometry2d::Point(-w / 2, l), Geometry2d::Point(0, 0));
+		_rightHalf = Geometry2d::Rect(Geometry2d::Point(0, l), Geometry2d::Point(w / 2, 0));
+
+		buildTable();
+	}
+
+
+	//	distance from (@x, @depth) to the flat part of the defense area, @depth measured from the goal line
+	static float distToFlat(float x, float depth) {
+		float dx = std::max(0.0f, std::fabs(x) - Dims::goalFlat() / 2);
+		return std::sqrt(dx * dx + depth * depth);
+	}
+
+
+	int cell(const Geometry2d::Point &pt) const {
+		int col = std::max(0, std::min(_cols - 1, (int)std::floor((pt.x + Dims::width() / 2) / tableResolution())));
+		int row = std::max(0, std::min(_rows - 1, (int)std::floor(pt.y / tableResolution())));
+		return row * _cols + col;
+	}
+
+
+	void buildTable() {
+		const float res = tableResolution();
+		const float l = Dims::length();
+		const float w = Dims::width();
+
+		_cols = std::max(1, (int)std::ceil(w / res));
+		_rows = std::max(1, (int)std::ceil(l / res));
+		_table.resize(_cols * _rows);
+		_edgeDistance.resize(_cols * _rows);
+
+		for ( int row = 0; row < _rows; row++ ) {
+			for ( int col = 0; col < _cols; col++ ) {
+				Geometry2d::Point pt(-w / 2 + (col + 0.5f) * res, (row + 0.5f) * res);
+
+				int third = pt.y < l / 3 ? ThirdDefense : (pt.y > l * 2 / 3 ? ThirdAttack : ThirdMidfield);
+				int side = pt.x < -w / 6 ? SideLeft : (pt.x > w / 6 ? SideRight : SideCenter);
+
+				int flags = 0;
+				if ( pt.y < l / 2 ) flags |= FlagOurHalf;
+				if ( inOurDefenseArea(pt) ) flags |= FlagOurDefenseArea;
+				if ( inTheirDefenseArea(pt) ) flags |= FlagTheirDefenseArea;
+				if ( inField(pt) ) flags |= FlagInField;
+
+				_table[row * _cols + col] = third | (side << 2) | (flags << 4);
+
+				float edge = std::min(std::min(pt.x + w / 2, w / 2 - pt.x), std::min(pt.y, l - pt.y));
+				_edgeDistance[row * _cols + col] = (uint16_t)(std::max(0.0f, edge) * 1000 + 0.5f);
+			}
+		}
+	}
+
+
+	Geometry2d::Segment _ourGoalLine;
+	Geometry2d::Segment _theirGoalLine;
+	Geometry2d::Segment _leftEdge;
+	Geometry2d::Segment _rightEdge;
+	Geometry2d::Segment _ourEndLine;
+	Geometry2d::Segment _theirEndLine;
+	Geometry2d::Segment _halfwayLine;
+
+	Geometry2d::Rect _field;
+	Geometry2d::Rect _ourHalf;
+	Geometry2d::Rect _theirHalf;
+	Geometry2d::Rect _leftHalf;
+	Geometry2d::Rect _rightHalf;
+
+	int _cols;
+	int _rows;
+
+	///	third in bits 0-1, side in bits 2-3, flags above
+	std::vector<uint8_t> _table;
+
+	///	millimeters
+	std::vector<uint16_t> _edgeDistance;
+};
+
+
+///	the field we play on
+typedef FieldModel<ConstantsFieldDims> Field;
@@ -0,0 +1,419 @@
+
+#include "GeometryBatch.hpp"
+
+#include <cmath>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace Geometry2d;
+
+
+
+//	Scalar kernels.  The AVX2 loops below do exactly these operations lane by lane, and use
+//	these for the elements left over after the last full group of eight.
+
+static inline float distToLineScalar(float ax, float ay, float dx, float dy, float invLen, float px, float py) {
+	float cross = dx * (py - ay) - dy * (px - ax);
+	return fabsf(cross) * invLen;
+}
+
+static inline float segmentParam(float ax, float ay, float dx, float dy, float invLenSq, float px, float py) {
+	float t = ((px - ax) * dx + (py - ay) * dy) * invLenSq;
+	return t < 0 ? 0 : (t > 1 ? 1 : t);
+}
+
+static inline float distToSegmentScalar(float ax, float ay, float dx, float dy, float invLenSq, float px, float py) {
+	float t = segmentParam(ax, ay, dx, dy, invLenSq, px, py);
+	float ex = ax + dx * t - px;
+	float ey = ay + dy * t - py;
+	return sqrtf(ex * ex + ey * ey);
+}
+
+static inline float inverseOrZero(float v) {
+	return v > 0 ? 1 / v : 0;
+}
+
+//	which side of the line through a with direction d the point p is on
+static inline float orient(float ax, float ay, float dx, float dy, float px, float py) {
+	return dx * (py - ay) - dy * (px - ax);
+}
+
+static inline bool segmentIntersectsScalar(float sax, float say, float sbx, float sby,
+										   float ax, float ay, float bx, float by)
+{
+	float sdx = sbx - sax;
+	float sdy = sby - say;
+	float dx = bx - ax;
+	float dy = by - ay;
+
+	float o1 = orient(sax, say, sdx, sdy, ax, ay);
+	float o2 = orient(sax, say, sdx, sdy, bx, by);
+	float o3 = orient(ax, ay, dx, dy, sax, say);
+	float o4 = orient(ax, ay, dx, dy, sbx, sby);
+
+	//	the bounding boxes overlapping handles collinear segments
+	bool boxes = fminf(sax, sbx) <= fmaxf(ax, bx) && fminf(ax, bx) <= fmaxf(sax, sbx) &&
+				 fminf(say, sby) <= fmaxf(ay, by) && fminf(ay, by) <= fmaxf(say, sby);
+
+	return o1 * o2 <= 0 && o3 * o4 <= 0 && boxes;
+}
+
+
+
+bool GeometryBatch::vectorized() {
+#ifdef __AVX2__
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+
+void GeometryBatch::distToLine(const Line &line, const float *x, const float *y, int n, float *out) {
+	const float ax = line.pt[0].x;
+	const float ay = line.pt[0].y;
+	const float dx = line.pt[1].x - ax;
+	const float dy = line.pt[1].y - ay;
+	const float len = sqrtf(dx * dx + dy * dy);
+
+	//	a degenerate line is just its point
+	if ( len == 0 ) {
+		distToSegment(Segment(line.pt[0], line.pt[0]), x, y, n, out);
+		return;
+	}
+	const float invLen = 1 / len;
+
+	int i = 0;
+#ifdef __AVX2__
+	const __m256 vax = _mm256_set1_ps(ax);
+	const __m256 vay = _mm256_set1_ps(ay);
+	const __m256 vdx = _mm256_set1_ps(dx);
+	const __m256 vdy = _mm256_set1_ps(dy);
+	const __m256 vinv = _mm256_set1_ps(invLen);
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+	for ( ; i + 8 <= n; i += 8 ) {
+		__m256 px = _mm256_loadu_ps(x + i);
+		__m256 py = _mm256_loadu_ps(y + i);
+		__m256 cross = _mm256_sub_ps(_mm256_mul_ps(vdx, _mm256_sub_ps(py, vay)),
+									 _mm256_mul_ps(vdy, _mm256_sub_ps(px, vax)));
+		_mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_and_ps(cross, absMask), vinv));
+	}
+#endif
+
+	for ( ; i < n; i++ ) {
+		out[i] = distToLineScalar(ax, ay, dx, dy, invLen, x[i], y[i]);
+	}
+}
+
+
+
+#ifdef __AVX2__
+//	segmentParam() on eight lanes
+static inline __m256 segmentParam8(__m256 ax, __m256 ay, __m256 dx, __m256 dy, __m256 invLenSq, __m256 px, __m256 py) {
+	__m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(px, ax), dx),
+										   _mm256_mul_ps(_mm256_sub_ps(py, ay), dy)),
+							 invLenSq);
+	return _mm256_min_ps(_mm256_max_ps(t, _mm256_setzero_ps()), _mm256_set1_ps(1));
+}
+
+//	distToSegmentScalar() on eight lanes
+static inline __m256 distToSegment8(__m256 ax, __m256 ay, __m256 dx, __m256 dy, __m256 invLenSq, __m256 px, __m256 py) {
+	__m256 t = segmentParam8(ax, ay, dx, dy, invLenSq, px, py);
+	__m256 ex = _mm256_sub_ps(_mm256_add_ps(ax, _mm256_mul_ps(dx, t)), px);
+	__m256 ey = _mm256_sub_ps(_mm256_add_ps(ay, _mm256_mul_ps(dy, t)), py);
+	return _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey)));
+}
+
+//	inverseOrZero() on eight lanes
+static inline __m256 inverseOrZero8(__m256 v) {
+	__m256 positive = _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GT_OQ);
+	return _mm256_and_ps(positive, _mm256_div_ps(_mm256_set1_ps(1), v));
+}
+
+//	writes the eight lane results of a comparison mask as bytes
+static inline void storeMask8(__m256 mask, uint8_t *out) {
+	int bits = _mm256_movemask_ps(mask);
+	for ( int k = 0; k < 8; k++ ) out[k] = (bits >> k) & 1;
+}
+#endif
+
+
+
+void GeometryBatch::distToSegment(const Segment &segment, const float *x, const float *y, int n, float *out) {
+	const float ax = segment.pt[0].x;
+	const float ay = segment.pt[0].y;
+	const float dx = segment.pt[1].x - ax;
+	const float dy = segment.pt[1].y - ay;
+	const float invLenSq = inverseOrZero(dx * dx + dy * dy);
+
+	int i = 0;
+#ifdef __AVX2__
+	const __m256 vax = _mm256_set1_ps(ax);
+	const __m256 vay = _mm256_set1_ps(ay);
+	const __m256 vdx = _mm256_set1_ps(dx);
+	const __m256 vdy = _mm256_set1_ps(dy);
+	const __m256 vinv = _mm256_set1_ps(invLenSq);
+
+	for ( ; i + 8 <= n; i += 8 ) {
+		__m256 d = distToSegment8(vax, vay, vdx, vdy, vinv, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i));
+		_mm256_storeu_ps(out + i, d);
+	}
+#endif
+
+	for ( ; i < n; i++ ) {
+		out[i] = distToSegmentScalar(ax, ay, dx, dy, invLenSq, x[i], y[i]);
+	}
+}
+
+
+
+void GeometryBatch::distToSegments(const Point &pt,
+								   const float *ax, const float *ay, const float *bx, const float *by,
+								   int n, float *out)
+{
+	int i = 0;
+#ifdef __AVX2__
+	const __m256 px = _mm256_set1_ps(pt.x);
+	const __m256 py = _mm256_set1_ps(pt.y);
+
+	for ( ; i + 8 <= n; i += 8 ) {
+		__m256 vax = _mm256_loadu_ps(ax + i);
+		__m256 vay = _mm256_loadu_ps(ay + i);
+		__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(bx + i), vax);
+		__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(by + i), vay);
+		__m256 inv = inverseOrZero8(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+		_mm256_storeu_ps(out + i, distToSegment8(vax, vay, dx, dy, inv, px, py));
+	}
+#endif
+
+	for ( ; i < n; i++ ) {
+		float dx = bx[i] - ax[i];
+		float dy = by[i] - ay[i];
+		out[i] = distToSegmentScalar(ax[i], ay[i], dx, dy, inverseOrZero(dx * dx + dy * dy), pt.x, pt.y);
+	}
+}
+
+
+
+void GeometryBatch::distToSegments(const Point &pt, const float *ax, const float *ay,
+								   const Point &b, int n, float *out)
+{
+	int i = 0;
+#ifdef __AVX2__
+	const __m256 px = _mm256_set1_ps(pt.x);
+	const __m256 py = _mm256_set1_ps(pt.y);
+	const __m256 vbx = _mm256_set1_ps(b.x);
+	const __m256 vby = _mm256_set1_ps(b.y);
+
+	for ( ; i + 8 <= n; i += 8 ) {
+		__m256 vax = _mm256_loadu_ps(ax + i);
+		__m256 vay = _mm256_loadu_ps(ay + i);
+		__m256 dx = _mm256_sub_ps(vbx, vax);
+		__m256 dy = _mm256_sub_ps(vby, vay);
+		__m256 inv = inverseOrZero8(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+		_mm256_storeu_ps(out + i, distToSegment8(vax, vay, dx, dy, inv, px, py));
+	}
+#endif
+
+	for ( ; i < n; i++ ) {
+		float dx = b.x - ax[i];
+		float dy = b.y - ay[i];
+		out[i] = distToSegmentScalar(ax[i], ay[i], dx, dy, inverseOrZero(dx * dx + dy * dy), pt.x, pt.y);
+	}
+}
+
+
+
+void GeometryBatch::nearestOnSegment(const Segment &segment, const float *x, const float *y, int n,
+									 float *outX, float *outY)
+{
+	const float ax = segment.pt[0].x;
+	const float ay = segment.pt[0].y;
+	const float dx = segment.pt[1].x - ax;
+	const float dy = segment.pt[1].y - ay;
+	const float invLenSq = inverseOrZero(dx * dx + dy * dy);
+
+	int i = 0;
+#ifdef __AVX2__
+	const __m256 vax = _mm256_set1_ps(ax);
+	const __m256 vay = _mm256_set1_ps(ay);
+	const __m256 vdx = _mm256_set1_ps(dx);
+	const __m256 vdy = _mm256_set1_ps(dy);
+	const __m256 vinv = _mm256_set1_ps(invLenSq);
+
+	for ( ; i + 8 <= n; i += 8 ) {
+		__m256 t = segmentParam8(vax, vay, vdx, vdy, vinv, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i));
+		_mm256_storeu_ps(outX + i, _mm256_add_ps(vax, _mm256_mul_ps(vdx, t)));
+		_mm256_storeu_ps(outY + i, _mm256_add_ps(vay, _mm256_mul_ps(vdy, t)));
+	}
+#endif
+
+	for ( ; i < n; i++ ) {
+		float t = segmentParam(ax, ay, dx, dy, invLenSq, x[i], y[i]);
+		outX[i] = ax + dx * t;
+		outY[i] = ay + dy * t;
+	}
+}
+
+
+
+void GeometryBatch::segmentIntersects(const Segment &segment,
+									  const float *ax, const float *ay, const float *bx, const float *by,
+									  int n, uint8_t *out)
+{
+	const float sax = segment.pt[0].x;
+	const float say = segment.pt[0].y;
+	const float sbx = segment.pt[1].x;
+	const float sby = segment.pt[1].y;
+
+	int i = 0;
+#ifdef __AVX2__
+	const __m256 vsax = _mm256_set1_ps(sax);
+	const __m256 vsay = _mm256_set1_ps(say);
+	const __m256 vsbx = _mm256_set1_ps(sbx);
+	const __m256 vsby = _mm256_set1_ps(sby);
+	const __m256 sdx = _mm256_set1_ps(sbx - sax);
+	const __m256 sdy = _mm256_set1_ps(sby - say);
+	const __m256 sminx = _mm256_set1_ps(fminf(sax, sbx));
+	const __m256 smaxx = _mm256_set1_ps(fmaxf(sax, sbx));
+	const __m256 sminy = _mm256_set1_ps(fminf(say, sby));
+	const __m256 smaxy = _mm256_set1_ps(fmaxf(say, sby));
+	const __m256 zero = _mm256_setzero_ps();
+
+	for ( ; i + 8 <= n; i += 8 ) {
+		__m256 vax = _mm256_loadu_ps(ax + i);
+		__m256 vay = _mm256_loadu_ps(ay + i);
+		__m256 vbx = _mm256_loadu_ps(bx + i);
+		__m256 vby = _mm256_loadu_ps(by + i);
+		__m256 dx = _mm256_sub_ps(vbx, vax);
+		__m256 dy = _mm256_sub_ps(vby, vay);
+
+		//	orient() for each end of each segment against the other
+		__m256 o1 = _mm256_sub_ps(_mm256_mul_ps(sdx, _mm256_sub_ps(vay, vsay)), _mm256_mul_ps(sdy, _mm256_sub_ps(vax, vsax)));
+		__m256 o2 = _mm256_sub_ps(_mm256_mul_ps(sdx, _mm256_sub_ps(vby, vsay)), _mm256_mul_ps(sdy, _mm256_sub_ps(vbx, vsax)));
+		__m256 o3 = _mm256_sub_ps(_mm256_mul_ps(dx, _mm256_sub_ps(vsay, vay)), _mm256_mul_ps(dy, _mm256_sub_ps(vsax, vax)));
+		__m256 o4 = _mm256_sub_ps(_mm256_mul_ps(dx, _mm256_sub_ps(vsby, vay)), _mm256_mul_ps(dy, _mm256_sub_ps(vsbx, vax)));
+
+		__m256 mask = _mm256_and_ps(_mm256_cmp_ps(_mm256_mul_ps(o1, o2), zero, _CMP_LE_OQ),
+									_mm256_cmp_ps(_mm256_mul_ps(o3, o4), zero, _CMP_LE_OQ));
+
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(sminx, _mm256_max_ps(vax, vbx), _CMP_LE_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(_mm256_min_ps(vax, vbx), smaxx, _CMP_LE_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(sminy, _mm256_max_ps(vay, vby), _CMP_LE_OQ));
+		mask = _mm256_and_ps(mask, _mm256_cmp_ps(_mm256_min_ps(vay, vby), smaxy, _CMP_LE_OQ));
+
+		storeMask8(mask, out + i);
+	}
+#endif
+
+	for ( ; i < n; i++ ) {
+		out[i] = segmentIntersectsScalar(sax, say, sbx, sby, ax[i], ay[i], bx[i], by[i]);
+	}
+}
+
+
+
+void GeometryBatch::lineCircleIntersects(const Circle &circle,
+										 const float *ax, const float *ay, const float *bx, const float *by,
+										 int n, uint8_t *hit, float *x0, float *y0, float *x1, float *y1)
+{
+	const float cx = circle.center.x;
+	const float cy = circle.center.y;
+	const float rSq = circle.radius() * circle.radius();
+
+	//	solves |a + d t - c|^2 = r^2 for t
+
+	int i = 0;
+#ifdef __AVX2__
+	const __m256 vcx = _mm256_set1_ps(cx);
+	const __m256 vcy = _mm256_set1_ps(cy);
+	const __m256 vrSq = _mm256_set1_ps(rSq);
+	const __m256 zero = _mm256_setzero_ps();
+
+	for ( ; i + 8 <= n; i += 8 ) {
+		__m256 vax = _mm256_loadu_ps(ax + i);
+		__m256 vay = _mm256_loadu_ps(ay + i);
+		__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(bx + i), vax);
+		__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(by + i), vay);
+		__m256 fx = _mm256_sub_ps(vax, vcx);
+		__m256 fy = _mm256_sub_ps(vay, vcy);
+
+		__m256 a = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+		__m256 b = _mm256_add_ps(_mm256_mul_ps(fx, dx), _mm256_mul_ps(fy, dy));
+		__m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(fx, fx), _mm256_mul_ps(fy, fy)), vrSq);
+		__m256 disc = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(a, c));
+
+		__m256 mask = _mm256_and_ps(_mm256_cmp_ps(disc, zero, _CMP_GE_OQ), _mm256_cmp_ps(a, zero, _CMP_GT_OQ));
+
+		//	lanes that miss compute garbage, which is fine since hit says to ignore them
+		__m256 root = _mm256_sqrt_ps(_mm256_max_ps(disc, zero));
+		__m256 inv = inverseOrZero8(a);
+		__m256 t0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(zero, b), root), inv);
+		__m256 t1 = _mm256_mul_ps(_mm256_add_ps(_mm256_sub_ps(zero, b), root), inv);
+
+		_mm256_storeu_ps(x0 + i, _mm256_add_ps(vax, _mm256_mul_ps(dx, t0)));
+		_mm256_storeu_ps(y0 + i, _mm256_add_ps(vay, _mm256_mul_ps(dy, t0)));
+		_mm256_storeu_ps(x1 + i, _mm256_add_ps(vax, _mm256_mul_ps(dx, t1)));
+		_mm256_storeu_ps(y1 + i, _mm256_add_ps(vay, _mm256_mul_ps(dy, t1)));
+		storeMask8(mask, hit + i);
+	}
+#endif
+
+	for ( ; i < n; i++ ) {
+		float dx = bx[i] - ax[i];
+		float dy = by[i] - ay[i];
+		float fx = ax[i] - cx;
+		float fy = ay[i] - cy;
+
+		float a = dx * dx + dy * dy;
+		float b = fx * dx + fy * dy;
+		float c = (fx * fx + fy * fy) - rSq;
+		float disc = b * b - a * c;
+
+		hit[i] = disc >= 0 && a > 0;
+
+		float root = sqrtf(fmaxf(disc, 0));
+		float inv = inverseOrZero(a);
+		float t0 = ((0 - b) - root) * inv;
+		float t1 = ((0 - b) + root) * inv;
+
+		x0[i] = ax[i] + dx * t0;
+		y0[i] = ay[i] + dy * t0;
+		x1[i] = ax[i] + dx * t1;
+		y1[i] = ay[i] + dy * t1;
+	}
+}
+
+
+
+void GeometryBatch::facing(const Point &target, float cosThreshold,
+						   const float *x, const float *y, const float *hx, const float *hy,
+						   int n, uint8_t *out)
+{
+	int i = 0;
+#ifdef __AVX2__
+	const __m256 tx = _mm256_set1_ps(target.x);
+	const __m256 ty = _mm256_set1_ps(target.y);
+	const __m256 vcos = _mm256_set1_ps(cosThreshold);
+
+	for ( ; i + 8 <= n; i += 8 ) {
+		__m256 dx = _mm256_sub_ps(tx, _mm256_loadu_ps(x + i));
+		__m256 dy = _mm256_sub_ps(ty, _mm256_loadu_ps(y + i));
+		__m256 dot = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(hx + i), dx), _mm256_mul_ps(_mm256_loadu_ps(hy + i), dy));
+		__m256 len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+		storeMask8(_mm256_cmp_ps(dot, _mm256_mul_ps(vcos, len), _CMP_GE_OQ), out + i);
+	}
+#endif
+
+	for ( ; i < n; i++ ) {
+		float dx = target.x - x[i];
+		float dy = target.y - y[i];
+		float dot = hx[i] * dx + hy[i] * dy;
+		float len = sqrtf(dx * dx + dy * dy);
+		out[i] = dot >= cosThreshold * len;
+	}
+}
@@ -0,0 +1,67 @@
+
+#pragma once
+
+#include <Geometry2d/Point.hpp>
+#include <Geometry2d/Line.hpp>
+#include <Geometry2d/Segment.hpp>
+#include <Geometry2d/Circle.hpp>
+
+#include <stdint.h>
+
+
+/**
+ *	Geometry2d operations over many points or segments at once.
+ *
+ *	Inputs and outputs are structure-of-arrays spans: parallel float arrays of length @n, laid
+ *	out like WorldSnapshot::Team.  When built with AVX2 (-mavx2) the loops run eight lanes at a
+ *	time, and any remainder goes through the same scalar code used when AVX2 is unavailable.
+ *	Both paths use the same formulas in the same order, so their results agree with each other.
+ *	They also agree with the scalar Geometry2d calls they replace, to within float rounding.
+ *
+ *	Boolean results are written one byte per element, 1 for true and 0 for false.
+ */
+class GeometryBatch {
+public:
+	///	Line::distTo() for each point
+	static void distToLine(const Geometry2d::Line &line, const float *x, const float *y, int n, float *out);
+
+	///	Segment::distTo() for each point
+	static void distToSegment(const Geometry2d::Segment &segment, const float *x, const float *y, int n, float *out);
+
+	///	distance from one point to each segment (@ax[i], @ay[i]) - (@bx[i], @by[i])
+	static void distToSegments(const Geometry2d::Point &pt,
+							   const float *ax, const float *ay, const float *bx, const float *by,
+							   int n, float *out);
+
+	///	distance from one point to each segment (@ax[i], @ay[i]) - @b, all sharing the endpoint @b
+	static void distToSegments(const Geometry2d::Point &pt, const float *ax, const float *ay,
+							   const Geometry2d::Point &b, int n, float *out);
+
+	///	Segment::nearestPoint() for each point
+	static void nearestOnSegment(const Geometry2d::Segment &segment, const float *x, const float *y, int n,
+								 float *outX, float *outY);
+
+	///	Segment::intersects(Segment) of @segment against each segment (@ax[i], @ay[i]) - (@bx[i], @by[i]).
+	///	Touching counts as intersecting.
+	static void segmentIntersects(const Geometry2d::Segment &segment,
+								  const float *ax, const float *ay, const float *bx, const float *by,
+								  int n, uint8_t *out);
+
+	///	Line::intersects(Circle) for each line through (@ax[i], @ay[i]) and (@bx[i], @by[i]).
+	///	Where there's a hit, (@x0, @y0) and (@x1, @y1) are the two intersection points, closest to
+	///	the line's first point first.
+	static void lineCircleIntersects(const Geometry2d::Circle &circle,
+									 const float *ax, const float *ay, const float *bx, const float *by,
+									 int n, uint8_t *hit, float *x0, float *y0, float *x1, float *y1);
+
+	///	Whether a robot at (@x[i], @y[i]) with unit heading (@hx[i], @hy[i]) is facing within the
+	///	angle whose cosine is @cosThreshold of @target.  This replaces Point::direction() and a
+	///	cos() per check with one dot product.
+	static void facing(const Geometry2d::Point &target, float cosThreshold,
+					   const float *x, const float *y, const float *hx, const float *hy,
+					   int n, uint8_t *out);
+
+
+	///	true if this build uses the AVX2 kernels
+	static bool vectorized();
+};
@@ -0,0 +1,110 @@
+
+#include "InterceptSolver.hpp"
+#include "BallModel.hpp"
+#include "MotionModel.hpp"
+
+#include <Constants.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace Geometry2d;
+
+
+
+REGISTER_CONFIGURABLE(InterceptSolver)
+
+ConfigDouble *InterceptSolver::_max_accel;
+ConfigDouble *InterceptSolver::_max_speed;
+ConfigDouble *InterceptSolver::_reaction_time;
+
+PerFrame<InterceptSolver> InterceptSolver::_current;
+
+
+
+void InterceptSolver::createConfiguration(Configuration *cfg)
+{
+	_max_accel = new ConfigDouble(cfg, "Intercept/Max Accel", 2.0);
+	_max_speed = new ConfigDouble(cfg, "Intercept/Max Speed", 2.0);
+	_reaction_time = new ConfigDouble(cfg, "Intercept/Reaction Time", 0.1);
+}
+
+
+
+InterceptSolver::InterceptSolver() {
+	_feasible = 0;
+	_fastest = -1;
+
+	for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+		_time[i] = 0;
+		_x[i] = _y[i] = 0;
+	}
+}
+
+
+
+const InterceptSolver &InterceptSolver::forState(SystemState *state) {
+	return _current.get(state, &InterceptSolver::solve, BallModel::forState(state));
+}
+
+
+
+void InterceptSolver::solve(const WorldSnapshot &world, const BallModel &ballModel) {
+	const WorldSnapshot::Team &us = world.us;
+	const int n = us.count;
+
+	const float maxAccel = *_max_accel;
+	const float maxSpeed = *_max_speed;
+	const float reaction = *_reaction_time;
+
+	//	the robot only has to get its edge to the ball
+	const float reach = Robot_Radius + Ball_Radius;
+
+	uint32_t pending = us.visible;
+	_feasible = 0;
+
+	const vector<BallModel::Sample> &samples = ballModel.samples();
+	for ( int k = 0; k < samples.size() && pending; k++ ) {
+		const BallModel::Sample &s = samples[k];
+
+		for ( int i = 0; i < n; i++ ) {
+			if ( !((pending >> i) & 1) ) continue;
+
+			float dx = s.pos.x - us.x[i];
+			float dy = s.pos.y - us.y[i];
+			float dist = sqrtf(dx * dx + dy * dy);
+
+			//	speed the robot already has toward the sample
+			float v0 = dist > 0 ? (us.vx[i] * dx + us.vy[i] * dy) / dist : 0;
+
+			float t = reaction + MotionModel::travelTime(dist - reach, v0, maxAccel, maxSpeed);
+			if ( t <= s.t ) {
+				_time[i] = s.t;
+				_x[i] = s.pos.x;
+				_y[i] = s.pos.y;
+				_feasible |= 1u << i;
+				pending &= ~(1u << i);
+			}
+		}
+	}
+
+	//	everyone else goes to where the ball stops
+	Point stop = ballModel.stopPoint();
+	for ( int i = 0; i < n; i++ ) {
+		if ( !((pending >> i) & 1) ) continue;
+
+		Point delta = stop - us.pos(i);
+		float dist = delta.mag();
+		float v0 = dist > 0 ? us.vel(i).dot(delta) / dist : 0;
+
+		_time[i] = max(ballModel.stopTime(), reaction + MotionModel::travelTime(dist - reach, v0, maxAccel, maxSpeed));
+		_x[i] = stop.x;
+		_y[i] = stop.y;
+	}
+
+	_fastest = -1;
+	for ( int i = 0; i < n; i++ ) {
+		if ( us.isVisible(i) && (_fastest < 0 || _time[i] < _time[_fastest]) ) _fastest = i;
+	}
+}
@@ -0,0 +1,82 @@
+
+#pragma once
+
+#include "Configuration.hpp"
+#include "WorldSnapshot.hpp"
+#include "PerFrame.hpp"
+
+class BallModel;
+
+
+/**
+ *	Finds, for each of our robots, the earliest point on the predicted ball path it can get to
+ *	before the ball does.
+ *
+ *	Runs once per frame for all of our robots at once: it walks the BallModel's sampled
+ *	trajectory and, at each sample, checks every robot that hasn't found an intercept yet using
+ *	a trapezoidal motion profile limited by the configured acceleration and speed.
+ *
+ *	Robots that can't beat the ball anywhere along its path are sent to the point where the
+ *	ball stops, and are marked as not feasible.
+ */
+class InterceptSolver {
+public:
+	static void createConfiguration(Configuration *cfg);
+
+
+	InterceptSolver();
+
+
+	///	returns the solution for the current frame, solving if this is the first call of the frame
+	static const InterceptSolver &forState(SystemState *state);
+
+
+	void solve(const WorldSnapshot &world, const BallModel &ballModel);
+
+
+	///	true if robot @i (an index into WorldSnapshot::us) reaches the ball path before the ball stops
+	bool feasible(int i) const {
+		return (_feasible >> i) & 1;
+	}
+
+	///	seconds from now until robot @i can touch the ball
+	float time(int i) const {
+		return _time[i];
+	}
+
+	///	where robot @i meets the ball
+	Geometry2d::Point point(int i) const {
+		return Geometry2d::Point(_x[i], _y[i]);
+	}
+
+
+	///	index of the visible robot that gets to the ball first, or -1 if there are none
+	int fastest() const {
+		return _fastest;
+	}
+
+
+	///	motion limits used for our robots, in m/s^2 and m/s
+	static float maxAccel() {
+		return *_max_accel;
+	}
+
+	static float maxSpeed() {
+		return *_max_speed;
+	}
+
+
+private:
+	float _time[WorldSnapshot::MaxRobots] STP_CACHE_ALIGNED;
+	float _x[WorldSnapshot::MaxRobots] STP_CACHE_ALIGNED;
+	float _y[WorldSnapshot::MaxRobots] STP_CACHE_ALIGNED;
+	uint32_t _feasible;
+	int _fastest;
+
+
+	static ConfigDouble *_max_accel;
+	static ConfigDouble *_max_speed;
+	static ConfigDouble *_reaction_time;
+
+	static PerFrame<InterceptSolver> _current;
+};
@@ -0,0 +1,160 @@
+
+#include "MarkingAssignment.hpp"
+
+#include <Constants.hpp>
+
+#include <cmath>
+#include <algorithm>
+#include <boost/foreach.hpp>
+
+using namespace std;
+using namespace Geometry2d;
+
+
+
+REGISTER_CONFIGURABLE(MarkingAssignment)
+
+ConfigDouble *MarkingAssignment::_goal_threat_weight;
+ConfigDouble *MarkingAssignment::_ball_threat_weight;
+ConfigDouble *MarkingAssignment::_ball_threat;
+ConfigDouble *MarkingAssignment::_block_radius;
+ConfigDouble *MarkingAssignment::_hysteresis;
+
+PerFrame<MarkingAssignment> MarkingAssignment::_current;
+
+
+
+void MarkingAssignment::createConfiguration(Configuration *cfg)
+{
+	_goal_threat_weight = new ConfigDouble(cfg, "Marking/Goal Threat Weight", 1.5);
+	_ball_threat_weight = new ConfigDouble(cfg, "Marking/Ball Threat Weight", 1.0);
+	_ball_threat = new ConfigDouble(cfg, "Marking/Ball Threat", 3.0);
+	_block_radius = new ConfigDouble(cfg, "Marking/Block Radius", 0.9);
+	_hysteresis = new ConfigDouble(cfg, "Marking/Hysteresis", 0.5);
+}
+
+
+
+MarkingAssignment::MarkingAssignment() {
+	_ballInArea = 0;
+	_world = NULL;
+
+	for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+		_threat[i] = 0;
+		_target[i] = NotDefender;
+		_previous[i] = NotDefender;
+	}
+}
+
+
+
+const MarkingAssignment &MarkingAssignment::forState(SystemState *state, const vector<Defender> &defenders) {
+	return _current.get(state, &MarkingAssignment::solve, defenders);
+}
+
+
+
+//	where a defender stands to block @target from our goal
+static Point blockPoint(const Point &target, float radius) {
+	float dist = target.mag();
+	if ( dist <= radius ) return target;
+	return target * (radius / dist);
+}
+
+
+
+void MarkingAssignment::solve(const WorldSnapshot &world, const vector<Defender> &defenders) {
+	const WorldSnapshot::Team &them = world.them;
+
+	for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+		_previous[i] = _target[i];
+		_target[i] = NotDefender;
+	}
+	_ballInArea = 0;
+	_world = &world;
+
+
+	//	threat of each opponent
+	const float goalWeight = *_goal_threat_weight;
+	const float ballWeight = *_ball_threat_weight;
+	int opponents[WorldSnapshot::MaxRobots];
+	int m = 0;
+	for ( int i = 0; i < them.count; i++ ) {
+		_threat[i] = 0;
+		if ( !them.isVisible(i) ) continue;
+
+		Point pos = them.pos(i);
+		float goalDist = min(pos.mag() / Field_Length, 1.0f);
+		float ballDist = min(pos.distTo(world.ballPos) / Field_Length, 1.0f);
+		_threat[i] = goalWeight * (1 - goalDist) + ballWeight * (1 - ballDist);
+
+		opponents[m++] = i;
+	}
+
+
+	//	rows are defenders that are on the field
+	int rows[WorldSnapshot::MaxRobots];
+	int n = 0;
+	for ( int d = 0; d < defenders.size() && n < WorldSnapshot::MaxRobots; d++ ) {
+		if ( world.indexOf(defenders[d].robot) >= 0 ) rows[n++] = d;
+	}
+	if ( n == 0 ) return;
+
+
+	//	columns are the visible opponents followed by one ball column per defender,
+	//	so every defender can fall back to the ball if there's nobody for it to mark
+	const int cols = m + n;
+	const float radius = *_block_radius;
+	const float hysteresis = *_hysteresis;
+	const Point ballBlock = blockPoint(world.ballPos, radius);
+
+	_cost.resize(n * cols);
+	_rowToCol.resize(n);
+
+	for ( int r = 0; r < n; r++ ) {
+		const Defender &def = defenders[rows[r]];
+		int self = world.indexOf(def.robot);
+		Point pos = world.us.pos(self);
+		float *row = &_cost[r * cols];
+
+		for ( int c = 0; c < m; c++ ) {
+			int opp = opponents[c];
+			if ( !def.area.contains(them.pos(opp)) ) {
+				row[c] = Assignment::Forbidden;
+				continue;
+			}
+
+			row[c] = pos.distTo(blockPoint(them.pos(opp), radius)) - _threat[opp];
+			if ( _previous[self] == opp ) row[c] -= hysteresis;
+		}
+
+		bool inArea = def.area.contains(world.ballPos);
+		if ( inArea ) _ballInArea |= 1u << self;
+
+		float ballCost = pos.distTo(ballBlock) - (inArea ? (float)*_ball_threat : 0);
+		if ( _previous[self] == Ball ) ballCost -= hysteresis;
+		for ( int c = m; c < cols; c++ ) row[c] = ballCost;
+	}
+
+	_solver.solve(&_cost[0], n, cols, &_rowToCol[0]);
+
+	for ( int r = 0; r < n; r++ ) {
+		int self = world.indexOf(defenders[rows[r]].robot);
+		int c = _rowToCol[r];
+		_target[self] = c < m ? opponents[c] : Ball;
+	}
+}
+
+
+
+int MarkingAssignment::target(const OurRobot *robot) const {
+	int i = _world ? _world->indexOf(robot) : -1;
+	return i >= 0 ? _target[i] : NotDefender;
+}
+
+
+
+bool MarkingAssignment::ballInArea(const OurRobot *robot) const {
+	int i = _world ? _world->indexOf(robot) : -1;
+	return i >= 0 && ((_ballInArea >> i) & 1);
+}
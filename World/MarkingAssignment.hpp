@@ -0,0 +1,95 @@
+
+#pragma once
+
+#include "Configuration.hpp"
+#include "WorldSnapshot.hpp"
+#include "Assignment.hpp"
+#include "PerFrame.hpp"
+
+#include <vector>
+
+
+/**
+ *	Decides, once per frame, what each defender marks.
+ *
+ *	Every visible opponent gets a threat based on how close it is to our goal and to the ball,
+ *	and the ball gets a fixed threat while it's inside a defender's area.  Each defender is then
+ *	matched to a distinct opponent, or to the ball, by minimizing the distance it has to travel
+ *	to its blocking point minus the threat it takes away.  This is solved as one assignment
+ *	problem so two defenders never mark the same attacker.
+ *
+ *	Keeping last frame's pairing is rewarded by the hysteresis bonus so marks don't flicker when
+ *	two opponents are about equally threatening.
+ */
+class MarkingAssignment {
+public:
+	static void createConfiguration(Configuration *cfg);
+
+
+	///	a defender taking part in the assignment
+	class Defender {
+	public:
+		Defender(OurRobot *robot, const Geometry2d::Rect &area) : robot(robot), area(area) {}
+
+		OurRobot *robot;
+
+		///	the defender only marks opponents, and the ball, inside this area
+		Geometry2d::Rect area;
+	};
+
+
+	///	values returned by target() that aren't opponent indices
+	static const int Ball = -1;
+	static const int NotDefender = -2;
+
+
+	MarkingAssignment();
+
+
+	///	returns the assignment for the current frame, solving it if this is the first call of the frame.
+	///	Every caller in a frame is expected to pass the same @defenders.
+	static const MarkingAssignment &forState(SystemState *state, const std::vector<Defender> &defenders);
+
+
+	void solve(const WorldSnapshot &world, const std::vector<Defender> &defenders);
+
+
+	///	index into WorldSnapshot::them of the opponent @robot should mark, Ball if it should block
+	///	the ball, or NotDefender if @robot wasn't one of the defenders.
+	int target(const OurRobot *robot) const;
+
+	///	true if the ball is inside the area of the defender using @robot
+	bool ballInArea(const OurRobot *robot) const;
+
+
+	///	threat of opponent @i this frame
+	float threat(int i) const {
+		return _threat[i];
+	}
+
+
+private:
+	float _threat[WorldSnapshot::MaxRobots];
+
+	///	indexed by WorldSnapshot::us index
+	int _target[WorldSnapshot::MaxRobots];
+	uint32_t _ballInArea;
+
+	///	last frame's _target, for hysteresis
+	int _previous[WorldSnapshot::MaxRobots];
+
+	Assignment _solver;
+	std::vector<float> _cost;
+	std::vector<int> _rowToCol;
+
+	const WorldSnapshot *_world;
+
+
+	static ConfigDouble *_goal_threat_weight;
+	static ConfigDouble *_ball_threat_weight;
+	static ConfigDouble *_ball_threat;
+	static ConfigDouble *_block_radius;
+	static ConfigDouble *_hysteresis;
+
+	static PerFrame<MarkingAssignment> _current;
+};
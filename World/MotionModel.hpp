@@ -0,0 +1,36 @@
+
+#pragma once
+
+#include <cmath>
+
+
+namespace MotionModel {
+
+	/**
+	 *	Seconds for a robot to cover @dist meters with a trapezoidal velocity profile,
+	 *	starting with speed @v0 toward the target (negative if moving away from it).
+	 *	The robot doesn't need to stop at the end.
+	 */
+	inline float travelTime(float dist, float v0, float maxAccel, float maxSpeed) {
+		float t = 0;
+
+		//	if we're moving away from the target we have to stop first, then come back
+		if ( v0 < 0 ) {
+			t += -v0 / maxAccel;
+			dist += v0 * v0 / (2 * maxAccel);
+			v0 = 0;
+		}
+		if ( v0 > maxSpeed ) v0 = maxSpeed;
+		if ( dist <= 0 ) return t;
+
+		//	distance covered while accelerating up to max speed
+		float accelDist = (maxSpeed * maxSpeed - v0 * v0) / (2 * maxAccel);
+
+		if ( dist <= accelDist ) {
+			return t + (sqrtf(v0 * v0 + 2 * maxAccel * dist) - v0) / maxAccel;
+		}
+
+		return t + (maxSpeed - v0) / maxAccel + (dist - accelDist) / maxSpeed;
+	}
+
+}
@@ -0,0 +1,70 @@
+
+#include "OpponentPrediction.hpp"
+
+#include <Constants.hpp>
+
+#include <cmath>
+
+using namespace Geometry2d;
+
+
+
+const float OpponentPrediction::HorizonTimes[NumHorizons] = { 0.1, 0.2, 0.3, 0.5, 1.0 };
+
+PerFrame<OpponentPrediction> OpponentPrediction::_current;
+
+
+
+OpponentPrediction::OpponentPrediction() {
+	visible = 0;
+	_prevVisible = 0;
+	_prevTimestamp = 0;
+
+	for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+		_angleVel[i] = 0;
+		_prevAngle[i] = 0;
+	}
+}
+
+
+
+const OpponentPrediction &OpponentPrediction::forState(SystemState *state) {
+	return _current.get(state, &OpponentPrediction::update);
+}
+
+
+
+void OpponentPrediction::update(const WorldSnapshot &world) {
+	const WorldSnapshot::Team &them = world.them;
+	const int n = WorldSnapshot::MaxRobots;
+
+	//	angular velocity from the change in angle since the last frame
+	//	note: timestamps are in microseconds
+	float dt = (world.timestamp > _prevTimestamp) ? (world.timestamp - _prevTimestamp) * 1.0e-6f : 0;
+	for ( int i = 0; i < n; i++ ) {
+		bool tracked = dt > 0 && dt < 0.1f && ((them.visible & _prevVisible) >> i & 1);
+		float delta = them.angle[i] - _prevAngle[i];
+		delta -= 360 * floor((delta + 180) / 360);		//	wrap to [-180, 180)
+		_angleVel[i] = tracked ? delta / dt : 0;
+		_prevAngle[i] = them.angle[i];
+	}
+	_prevVisible = them.visible;
+	_prevTimestamp = world.timestamp;
+
+
+	//	one straight pass per horizon over the SoA arrays
+	for ( int h = 0; h < NumHorizons; h++ ) {
+		const float t = HorizonTimes[h];
+		for ( int i = 0; i < n; i++ ) {
+			x[h][i] = them.x[i] + them.vx[i] * t;
+			y[h][i] = them.y[i] + them.vy[i] * t;
+			angle[h][i] = them.angle[i] + _angleVel[i] * t;
+		}
+		for ( int i = 0; i < n; i++ ) {
+			hx[h][i] = cos(angle[h][i] * DegreesToRadians);
+			hy[h][i] = sin(angle[h][i] * DegreesToRadians);
+		}
+	}
+
+	visible = them.visible;
+}
@@ -0,0 +1,79 @@
+
+#pragma once
+
+#include "WorldSnapshot.hpp"
+#include "PerFrame.hpp"
+
+
+/**
+ *	Constant-velocity predictions of every visible opponent at a few fixed horizons.
+ *
+ *	Marking, interception and pass-lane code all want to know where the opponents will be
+ *	a moment from now.  Instead of each Action extrapolating pos + vel * t for the robots it
+ *	cares about, the whole table is filled in one pass over the WorldSnapshot arrays each frame.
+ *
+ *	Headings are extrapolated with an angular velocity estimated from the previous frame.
+ *	Robots that aren't visible are extrapolated by their last velocity like the others, but their
+ *	heading isn't turned.  Check @visible before trusting an entry.
+ */
+class OpponentPrediction {
+public:
+
+	typedef enum {
+		Horizon100ms,
+		Horizon200ms,
+		Horizon300ms,
+		Horizon500ms,
+		Horizon1s,
+		NumHorizons
+	} Horizon;
+
+
+	///	seconds into the future for each Horizon
+	static const float HorizonTimes[NumHorizons];
+
+
+	OpponentPrediction();
+
+
+	///	returns the table for the current frame, filling it if this is the first call of the frame
+	static const OpponentPrediction &forState(SystemState *state);
+
+
+	void update(const WorldSnapshot &world);
+
+
+	///	predicted position of opponent @i (an index into WorldSnapshot::them)
+	Geometry2d::Point pos(int i, Horizon h) const {
+		return Geometry2d::Point(x[h][i], y[h][i]);
+	}
+
+	///	predicted unit heading vector of opponent @i
+	Geometry2d::Point heading(int i, Horizon h) const {
+		return Geometry2d::Point(hx[h][i], hy[h][i]);
+	}
+
+
+	float x[NumHorizons][WorldSnapshot::MaxRobots] STP_CACHE_ALIGNED;
+	float y[NumHorizons][WorldSnapshot::MaxRobots] STP_CACHE_ALIGNED;
+
+	///	degrees, same as Robot::angle
+	float angle[NumHorizons][WorldSnapshot::MaxRobots] STP_CACHE_ALIGNED;
+	float hx[NumHorizons][WorldSnapshot::MaxRobots] STP_CACHE_ALIGNED;
+	float hy[NumHorizons][WorldSnapshot::MaxRobots] STP_CACHE_ALIGNED;
+
+	///	same as WorldSnapshot::them.visible for the frame the table was built from
+	uint32_t visible;
+
+
+private:
+	///	estimated angular velocity of each opponent in degrees per second
+	float _angleVel[WorldSnapshot::MaxRobots] STP_CACHE_ALIGNED;
+
+	float _prevAngle[WorldSnapshot::MaxRobots];
+	uint32_t _prevVisible;
+	uint64_t _prevTimestamp;
+
+
+	static PerFrame<OpponentPrediction> _current;
+};
@@ -0,0 +1,267 @@
+
+#include "PassEvaluator.hpp"
+#include "InterceptSolver.hpp"
+#include "MotionModel.hpp"
+#include "FieldModel.hpp"
+
+#include <Constants.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace Geometry2d;
+
+
+
+REGISTER_CONFIGURABLE(PassEvaluator)
+
+ConfigDouble *PassEvaluator::_resolution;
+ConfigDouble *PassEvaluator::_lane_clearance;
+ConfigDouble *PassEvaluator::_max_reach_time;
+ConfigDouble *PassEvaluator::_lane_weight;
+ConfigDouble *PassEvaluator::_reach_weight;
+ConfigDouble *PassEvaluator::_shot_weight;
+ConfigDouble *PassEvaluator::_move_threshold;
+ConfigDouble *PassEvaluator::_velocity_threshold;
+
+PerFrame<PassEvaluator> PassEvaluator::_current;
+
+
+//	robots this close to the ball are the passer, not a receiver
+static const float PasserDistance = 0.2;
+
+
+
+void PassEvaluator::createConfiguration(Configuration *cfg)
+{
+	_resolution = new ConfigDouble(cfg, "Pass/Grid Resolution", 0.2);
+	_lane_clearance = new ConfigDouble(cfg, "Pass/Lane Clearance", 0.5);
+	_max_reach_time = new ConfigDouble(cfg, "Pass/Max Reach Time", 3.0);
+	_lane_weight = new ConfigDouble(cfg, "Pass/Lane Weight", 1.0);
+	_reach_weight = new ConfigDouble(cfg, "Pass/Reach Weight", 1.0);
+	_shot_weight = new ConfigDouble(cfg, "Pass/Shot Weight", 0.5);
+	_move_threshold = new ConfigDouble(cfg, "Pass/Move Threshold", 0.02);
+	_velocity_threshold = new ConfigDouble(cfg, "Pass/Velocity Threshold", 0.05);
+}
+
+
+
+PassEvaluator::PassEvaluator() {
+	_oppVisible = 0;
+	_usVisible = 0;
+	_valid = false;
+}
+
+
+
+const PassEvaluator &PassEvaluator::forState(SystemState *state) {
+	return _current.get(state, &PassEvaluator::update);
+}
+
+
+
+void PassEvaluator::layout(float resolution) {
+	_grid.resize(resolution);
+	const int cells = _grid.size();
+
+	_cx.resize(cells);
+	_cy.resize(cells);
+	_shot.resize(cells);
+	_score.resize(cells);
+	_minReach.resize(cells);
+	_lane.resize(cells * WorldSnapshot::MaxRobots);
+	_reach.resize(cells * WorldSnapshot::MaxRobots);
+
+	const Point leftPost = Field::instance().theirGoalLine().pt[0];
+	const Point rightPost = Field::instance().theirGoalLine().pt[1];
+
+	for ( int c = 0; c < cells; c++ ) {
+		Point center = _grid.center(c);
+		_cx[c] = center.x;
+		_cy[c] = center.y;
+
+		//	angle between the posts, normalized by a half turn
+		Point a = (leftPost - center).normalized();
+		Point b = (rightPost - center).normalized();
+		_shot[c] = acos(max(-1.0f, min(1.0f, a.dot(b)))) / M_PI;
+	}
+
+	_valid = false;
+}
+
+
+
+void PassEvaluator::updateLane(const WorldSnapshot &world, int opp) {
+	const int cells = _grid.size();
+	float *lane = &_lane[opp * cells];
+
+	const float bx = _ballPos.x;
+	const float by = _ballPos.y;
+	const float px = world.them.x[opp] - bx;
+	const float py = world.them.y[opp] - by;
+
+	//	distance from the opponent to the segment from the ball to each cell
+	for ( int c = 0; c < cells; c++ ) {
+		float dx = _cx[c] - bx;
+		float dy = _cy[c] - by;
+		float lenSq = dx * dx + dy * dy;
+		float t = lenSq > 0 ? (px * dx + py * dy) / lenSq : 0;
+		t = t < 0 ? 0 : (t > 1 ? 1 : t);
+		float ex = px - dx * t;
+		float ey = py - dy * t;
+		lane[c] = sqrtf(ex * ex + ey * ey);
+	}
+}
+
+
+
+void PassEvaluator::updateReach(const WorldSnapshot &world, int robot) {
+	const int cells = _grid.size();
+	float *reach = &_reach[robot * cells];
+
+	const float rx = world.us.x[robot];
+	const float ry = world.us.y[robot];
+	const float vx = world.us.vx[robot];
+	const float vy = world.us.vy[robot];
+
+	//	same limits the intercept solver uses
+	const float maxAccel = InterceptSolver::maxAccel();
+	const float maxSpeed = InterceptSolver::maxSpeed();
+
+	for ( int c = 0; c < cells; c++ ) {
+		float dx = _cx[c] - rx;
+		float dy = _cy[c] - ry;
+		float dist = sqrtf(dx * dx + dy * dy);
+		float v0 = dist > 0 ? (vx * dx + vy * dy) / dist : 0;
+		reach[c] = MotionModel::travelTime(dist, v0, maxAccel, maxSpeed);
+	}
+}
+
+
+
+void PassEvaluator::update(const WorldSnapshot &world) {
+	if ( !_valid || _grid.cellSize() != (float)*_resolution ) {
+		layout(*_resolution);
+	}
+
+	const float threshSq = *_move_threshold * *_move_threshold;
+	const float velThreshSq = *_velocity_threshold * *_velocity_threshold;
+	bool changed = false;
+
+	//	lanes all depend on the ball, so if it moved they all have to be redone
+	bool ballMoved = !_valid || (world.ballPos - _ballPos).magsq() > threshSq;
+	if ( ballMoved ) _ballPos = world.ballPos;
+
+	for ( int i = 0; i < world.them.count; i++ ) {
+		if ( !world.them.isVisible(i) ) continue;
+
+		float dx = world.them.x[i] - _oppX[i];
+		float dy = world.them.y[i] - _oppY[i];
+		bool moved = !((_oppVisible >> i) & 1) || dx * dx + dy * dy > threshSq;
+
+		if ( ballMoved || moved ) {
+			_oppX[i] = world.them.x[i];
+			_oppY[i] = world.them.y[i];
+			updateLane(world, i);
+			changed = true;
+		}
+	}
+
+	for ( int i = 0; i < world.us.count; i++ ) {
+		if ( !world.us.isVisible(i) ) continue;
+
+		//	reach times depend on the velocity too
+		float dx = world.us.x[i] - _usX[i];
+		float dy = world.us.y[i] - _usY[i];
+		float dvx = world.us.vx[i] - _usVx[i];
+		float dvy = world.us.vy[i] - _usVy[i];
+		bool moved = !_valid || !((_usVisible >> i) & 1) || dx * dx + dy * dy > threshSq ||
+				dvx * dvx + dvy * dvy > velThreshSq;
+
+		if ( moved ) {
+			_usX[i] = world.us.x[i];
+			_usY[i] = world.us.y[i];
+			_usVx[i] = world.us.vx[i];
+			_usVy[i] = world.us.vy[i];
+			updateReach(world, i);
+			changed = true;
+		}
+	}
+
+	changed = changed || ballMoved || world.them.visible != _oppVisible || world.us.visible != _usVisible;
+	_oppVisible = world.them.visible;
+	_usVisible = world.us.visible;
+	_valid = true;
+
+	if ( changed ) combine(world);
+}
+
+
+
+void PassEvaluator::combine(const WorldSnapshot &world) {
+	const int cells = _grid.size();
+
+	const float laneWeight = *_lane_weight;
+	const float reachWeight = *_reach_weight;
+	const float shotWeight = *_shot_weight;
+	const float totalWeight = laneWeight + reachWeight + shotWeight;
+	const float invClearance = 1.0f / *_lane_clearance;
+	const float invMaxReach = 1.0f / *_max_reach_time;
+
+	//	start from the best case and take minimums over the robots
+	vector<float> &lane = _score;
+	vector<float> &reach = _minReach;
+	fill(lane.begin(), lane.end(), (float)*_lane_clearance);
+	fill(reach.begin(), reach.end(), (float)*_max_reach_time);
+
+	for ( int i = 0; i < world.them.count; i++ ) {
+		if ( !world.them.isVisible(i) ) continue;
+
+		const float *column = &_lane[i * cells];
+		for ( int c = 0; c < cells; c++ ) {
+			lane[c] = min(lane[c], column[c]);
+		}
+	}
+
+	for ( int i = 0; i < world.us.count; i++ ) {
+		if ( !world.us.isVisible(i) ) continue;
+		if ( world.us.pos(i).nearPoint(_ballPos, PasserDistance) ) continue;
+
+		const float *column = &_reach[i * cells];
+		for ( int c = 0; c < cells; c++ ) {
+			reach[c] = min(reach[c], column[c]);
+		}
+	}
+
+	for ( int c = 0; c < cells; c++ ) {
+		float laneScore = lane[c] * invClearance;
+		float reachScore = 1 - reach[c] * invMaxReach;
+		_score[c] = (laneWeight * laneScore + reachWeight * reachScore + shotWeight * _shot[c]) / totalWeight;
+	}
+}
+
+
+
+bool PassEvaluator::best(const Rect &region, Point &out, float *outScore) const {
+	float x0 = min(region.pt[0].x, region.pt[1].x);
+	float x1 = max(region.pt[0].x, region.pt[1].x);
+	float y0 = min(region.pt[0].y, region.pt[1].y);
+	float y1 = max(region.pt[0].y, region.pt[1].y);
+
+	int bestCell = -1;
+	for ( int row = _grid.row(y0); row <= _grid.row(y1); row++ ) {
+		for ( int col = _grid.col(x0); col <= _grid.col(x1); col++ ) {
+			int c = _grid.index(col, row);
+			if ( _cx[c] < x0 || _cx[c] > x1 || _cy[c] < y0 || _cy[c] > y1 ) continue;
+
+			if ( bestCell < 0 || _score[c] > _score[bestCell] ) bestCell = c;
+		}
+	}
+
+	if ( bestCell < 0 ) return false;
+
+	out = _grid.center(bestCell);
+	if ( outScore ) *outScore = _score[bestCell];
+	return true;
+}
@@ -0,0 +1,118 @@
+
+#pragma once
+
+#include "Configuration.hpp"
+#include "WorldSnapshot.hpp"
+#include "FieldGrid.hpp"
+#include "PerFrame.hpp"
+
+#include <Geometry2d/Rect.hpp>
+
+#include <vector>
+
+
+/**
+ *	Scores a grid of candidate pass receive points covering the field, once per frame.
+ *
+ *	Each cell's score in [0, 1] combines:
+ *		lane	- how far the closest opponent is from the pass line from the ball to the cell
+ *		reach	- how quickly the closest of our robots can get to the cell
+ *		shot	- the angle the opponent's goal mouth subtends from the cell
+ *
+ *	Lane clearance and reach time are stored per robot per cell, so when only a few robots moved
+ *	(or, for reach, changed velocity) since the previous frame only their columns are recomputed
+ *	before the per-cell minimum is taken again.  Every cell loop runs over contiguous arrays of
+ *	cell coordinates so the compiler can vectorize it.
+ *
+ *	Actions get the frame's evaluator through Action::passEvaluator() when they need to pick
+ *	where to receive the ball.
+ */
+class PassEvaluator {
+public:
+	static void createConfiguration(Configuration *cfg);
+
+
+	PassEvaluator();
+
+
+	///	returns the evaluator for the current frame, updating it if this is the first call of the frame
+	static const PassEvaluator &forState(SystemState *state);
+
+
+	void update(const WorldSnapshot &world);
+
+
+	const FieldGrid &grid() const {
+		return _grid;
+	}
+
+	///	score of the cell containing @pt
+	float score(const Geometry2d::Point &pt) const {
+		return _score[_grid.index(pt)];
+	}
+
+	///	all cell scores, indexed like FieldGrid
+	const std::vector<float> &scores() const {
+		return _score;
+	}
+
+
+	///	Center of the best scoring cell inside @region.
+	///	Returns false if @region doesn't contain any cell centers.
+	bool best(const Geometry2d::Rect &region, Geometry2d::Point &out, float *outScore = NULL) const;
+
+
+protected:
+	void layout(float resolution);
+
+	void updateLane(const WorldSnapshot &world, int opp);
+	void updateReach(const WorldSnapshot &world, int robot);
+	void combine(const WorldSnapshot &world);
+
+
+private:
+	FieldGrid _grid;
+
+	//	cell centers
+	std::vector<float> _cx;
+	std::vector<float> _cy;
+
+	///	static part of the score, depends only on the cell
+	std::vector<float> _shot;
+
+	///	_lane[opp * cells + cell] = distance from opponent opp to the pass line to cell
+	std::vector<float> _lane;
+
+	///	_reach[robot * cells + cell] = seconds for our robot to get to cell
+	std::vector<float> _reach;
+
+	std::vector<float> _score;
+
+	///	scratch space for combine()
+	std::vector<float> _minReach;
+
+
+	//	what the stored columns were computed from
+	Geometry2d::Point _ballPos;
+	float _oppX[WorldSnapshot::MaxRobots];
+	float _oppY[WorldSnapshot::MaxRobots];
+	float _usX[WorldSnapshot::MaxRobots];
+	float _usY[WorldSnapshot::MaxRobots];
+	float _usVx[WorldSnapshot::MaxRobots];
+	float _usVy[WorldSnapshot::MaxRobots];
+	uint32_t _oppVisible;
+	uint32_t _usVisible;
+	bool _valid;
+
+
+	static ConfigDouble *_resolution;
+	static ConfigDouble *_lane_clearance;
+	static ConfigDouble *_max_reach_time;
+	static ConfigDouble *_lane_weight;
+	static ConfigDouble *_reach_weight;
+	static ConfigDouble *_shot_weight;
+	static ConfigDouble *_move_threshold;
+	static ConfigDouble *_velocity_threshold;
+
+	static PerFrame<PassEvaluator> _current;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <framework/SystemState.hpp>
+
+#include <stdint.h>
+
+
+/**
+ *	One lazily updated value per frame, for the forState() accessors of the World services.
+ *
+ *	get() runs the given update on the value the first time it's asked for in a frame, that is
+ *	for a new SystemState or a new SystemState::timestamp, and returns the stored value after that.
+ *	The update can take the SystemState, another service's value for the frame (found through its
+ *	own forState()), or such a value and one extra argument.
+ *
+ *	Declare one as a static member of the service and return get() from forState():
+ *
+ *		const ThreatMap &ThreatMap::forState(SystemState *state) {
+ *			return _current.get(state, &ThreatMap::update);
+ *		}
+ */
+template<class T>
+class PerFrame {
+public:
+	PerFrame() : _state(NULL), _timestamp(0) {}
+
+
+	const T &get(SystemState *state, void (T::*update)(SystemState *)) {
+		if ( stale(state) ) {
+			(_value.*update)(state);
+			mark(state);
+		}
+		return _value;
+	}
+
+	///	@update takes the frame's value of another service @U
+	template<class U>
+	const T &get(SystemState *state, void (T::*update)(const U &)) {
+		if ( stale(state) ) {
+			(_value.*update)(U::forState(state));
+			mark(state);
+		}
+		return _value;
+	}
+
+	///	@update takes the frame's value of another service @U, and @arg
+	template<class U, class A>
+	const T &get(SystemState *state, void (T::*update)(const U &, const A &), const A &arg) {
+		if ( stale(state) ) {
+			(_value.*update)(U::forState(state), arg);
+			mark(state);
+		}
+		return _value;
+	}
+
+
+private:
+	bool stale(SystemState *state) const {
+		return state != _state || state->timestamp != _timestamp;
+	}
+
+	//	only after the update, so one that throws is tried again next time
+	void mark(SystemState *state) {
+		_state = state;
+		_timestamp = state->timestamp;
+	}
+
+	T _value;
+	SystemState *_state;
+	uint64_t _timestamp;
+};
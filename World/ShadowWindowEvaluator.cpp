@@ -0,0 +1,169 @@
+
+#include "ShadowWindowEvaluator.hpp"
+#include "WindowCache.hpp"
+
+#include <Constants.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace Geometry2d;
+
+
+
+//	marks a shadow slot as unused so it sorts to the end of the sweep
+const float ShadowWindowEvaluator::NoShadow = 1.0e9;
+
+static const float RadToDeg = 180.0 / M_PI;
+
+
+
+//	wraps an angle to [-pi, pi)
+static inline float wrapAngle(float a) {
+	return a - 2 * M_PI * floor((a + M_PI) / (2 * M_PI));
+}
+
+
+
+//	orders obstacle indices by where their shadows start
+class ShadowStartComparator {
+public:
+	ShadowStartComparator(const float *start) : _start(start) {}
+
+	bool operator()(int a, int b) const {
+		return _start[a] < _start[b];
+	}
+
+private:
+	const float *_start;
+};
+
+
+
+ShadowWindowEvaluator::View::View(const Point &origin_, const Segment &target, float maxDist_) {
+	origin = origin_;
+	p0 = target.pt[0];
+	mouth = target.pt[1] - target.pt[0];
+	maxDist = maxDist_;
+
+	base = (p0 - origin).angle();
+	span = wrapAngle((target.pt[1] - origin).angle() - base);
+	sign = span < 0 ? -1 : 1;
+	span *= sign;
+
+	offset = (p0 - origin).cross(mouth);
+}
+
+
+
+ShadowWindowEvaluator::ShadowWindowEvaluator(SystemState *state) {
+	_state = state;
+	debug = false;
+}
+
+
+
+void ShadowWindowEvaluator::run(const Point &origin, const Segment &target, ShadowWindowBuffer &out) {
+	evaluate(origin, target, -1, out);
+}
+
+
+
+void ShadowWindowEvaluator::run(const Segment &target, const Point &origin, float dist, ShadowWindowBuffer &out) {
+	evaluate(origin, target, dist, out);
+}
+
+
+
+void ShadowWindowEvaluator::evaluate(const Point &origin, const Segment &target, float maxDist, ShadowWindowBuffer &out) {
+	const WindowCache::Entry &entry = WindowCache::lookup(_state, origin, target, maxDist, exclude);
+
+	_origin = entry.view.origin;
+	out = entry.windows;
+}
+
+
+
+void ShadowWindowEvaluator::computeShadows(const View &view, const float *x, const float *y, int n, float *start, float *end) {
+	const bool inFrontOnly = view.maxDist < 0;
+	const float radius = Robot_Radius;
+
+	for ( int i = 0; i < n; i++ ) {
+		float dx = x[i] - view.origin.x;
+		float dy = y[i] - view.origin.y;
+		float dist = sqrtf(dx * dx + dy * dy);
+
+		bool valid = dist > radius;
+		if ( inFrontOnly ) {
+			//	distance along the ray to the target line, in units of dist
+			float rate = dx * view.mouth.y - dy * view.mouth.x;
+			valid = valid && rate != 0 && view.offset / rate > 1;
+		} else {
+			valid = valid && dist <= view.maxDist;
+		}
+
+		float center = wrapAngle(atan2f(dy, dx) - view.base) * view.sign;
+		float halfWidth = asinf(min(1.0f, radius / max(dist, radius)));
+
+		start[i] = valid ? center - halfWidth : NoShadow;
+		end[i] = valid ? center + halfWidth : NoShadow;
+	}
+}
+
+
+
+void ShadowWindowEvaluator::sweep(const View &view, const float *start, const float *end, int n, ShadowWindowBuffer &out) {
+	out.clear();
+
+	int order[MaxObstacles];
+	n = min(n, (int)MaxObstacles);
+	for ( int i = 0; i < n; i++ ) order[i] = i;
+	sort(order, order + n, ShadowStartComparator(start));
+
+	//	emit the gaps between the shadows as angle ranges
+	float openStart[MaxObstacles + 1];
+	float openEnd[MaxObstacles + 1];
+	int openCount = 0;
+
+	float covered = 0;
+	for ( int k = 0; k < n && covered < view.span; k++ ) {
+		int i = order[k];
+		if ( start[i] >= NoShadow ) break;
+
+		if ( start[i] > covered ) {
+			openStart[openCount] = covered;
+			openEnd[openCount] = min(start[i], view.span);
+			openCount++;
+		}
+		covered = max(covered, end[i]);
+	}
+	if ( covered < view.span ) {
+		openStart[openCount] = covered;
+		openEnd[openCount] = view.span;
+		openCount++;
+	}
+
+
+	//	turn the open angle ranges into pieces of the target segment
+	const float mouthLenSq = view.mouth.magsq();
+	for ( int w = 0; w < openCount; w++ ) {
+		float s[2];
+		float angles[2] = { openStart[w], openEnd[w] };
+		for ( int e = 0; e < 2; e++ ) {
+			Point dir = Point::direction(view.base + view.sign * angles[e]);
+			float rate = dir.cross(view.mouth);
+			float along = rate != 0 ? view.offset / rate : 0;
+			Point hit = view.origin + dir * along;
+			s[e] = mouthLenSq > 0 ? max(0.0f, min(1.0f, (hit - view.p0).dot(view.mouth) / mouthLenSq)) : 0;
+		}
+		if ( s[1] - s[0] <= 0 ) continue;
+
+		ShadowWindow *window = out.add();
+		if ( !window ) break;
+
+		window->segment = Segment(view.p0 + view.mouth * s[0], view.p0 + view.mouth * s[1]);
+		window->a0 = (window->segment.pt[0] - view.origin).angle() * RadToDeg;
+		window->a1 = (window->segment.pt[1] - view.origin).angle() * RadToDeg;
+	}
+}
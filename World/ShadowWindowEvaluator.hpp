@@ -0,0 +1,169 @@
+
+#pragma once
+
+#include "WorldSnapshot.hpp"
+
+#include <Geometry2d/Point.hpp>
+#include <Geometry2d/Segment.hpp>
+
+#include <vector>
+
+
+///	a clear section of the target segment, same meaning as Gameplay::Window
+class ShadowWindow {
+public:
+	///	the clear part of the target, in the same direction as the target
+	Geometry2d::Segment segment;
+
+	///	angles in degrees from the origin to segment.pt[0] and segment.pt[1]
+	float a0;
+	float a1;
+};
+
+
+///	fixed-capacity, caller-owned storage for the windows found by a ShadowWindowEvaluator
+class ShadowWindowBuffer {
+public:
+	///	n obstacles can split the target into at most n + 1 windows
+	static const int Capacity = 2 * WorldSnapshot::MaxRobots + 1;
+
+	typedef ShadowWindow *iterator;
+	typedef const ShadowWindow *const_iterator;
+
+
+	ShadowWindowBuffer() : _count(0) {}
+
+
+	int size() const {
+		return _count;
+	}
+
+	bool empty() const {
+		return _count == 0;
+	}
+
+	void clear() {
+		_count = 0;
+	}
+
+	///	returns NULL if the buffer is full
+	ShadowWindow *add() {
+		return _count < Capacity ? &_windows[_count++] : NULL;
+	}
+
+	ShadowWindow &operator[](int i) {
+		return _windows[i];
+	}
+
+	const ShadowWindow &operator[](int i) const {
+		return _windows[i];
+	}
+
+	iterator begin() {
+		return _windows;
+	}
+
+	iterator end() {
+		return _windows + _count;
+	}
+
+	const_iterator begin() const {
+		return _windows;
+	}
+
+	const_iterator end() const {
+		return _windows + _count;
+	}
+
+
+private:
+	ShadowWindow _windows[Capacity];
+	int _count;
+};
+
+
+
+/**
+ *	Finds the parts of a target segment that are visible from an origin past the robots on the
+ *	field.  This is a replacement backend for Gameplay::WindowEvaluator with the same meaning
+ *	for @exclude and for the windows' segment, a0 and a1.
+ *
+ *	Every visible robot except those at an @exclude point is an obstacle.  All of the obstacles'
+ *	angular shadows are computed in one pass over flat arrays, then the shadows are sorted and
+ *	swept once (O(n log n)) to produce the windows.  Results go into a ShadowWindowBuffer
+ *	supplied by the caller, so nothing is allocated per frame.
+ *
+ *	Evaluations go through the WindowCache, so Actions asking the same question in a frame
+ *	share one answer, and the cache's entries are a fixed table.
+ */
+class ShadowWindowEvaluator {
+public:
+	static const int MaxObstacles = 2 * WorldSnapshot::MaxRobots;
+
+
+	///	where an evaluation looks from and at, with the values the shadow math needs
+	class View {
+	public:
+		///	@maxDist < 0 means only obstacles in front of the target line cast shadows
+		View(const Geometry2d::Point &origin, const Geometry2d::Segment &target, float maxDist);
+
+		Geometry2d::Point origin;
+		Geometry2d::Point p0;
+		Geometry2d::Point mouth;
+		float maxDist;
+
+		///	angles are measured in radians from the direction of p0, increasing toward the other end
+		float base;
+		float sign;
+		float span;
+
+		///	(p0 - origin) x mouth, for distances along rays to the target line
+		float offset;
+	};
+
+
+	ShadowWindowEvaluator(SystemState *state);
+
+
+	///	Windows on @target as seen from @origin.
+	///	Only obstacles between @origin and the line through @target cast shadows.
+	void run(const Geometry2d::Point &origin, const Geometry2d::Segment &target, ShadowWindowBuffer &out);
+
+
+	///	Windows on @target as seen from @origin, where every obstacle within @dist of @origin
+	///	casts a shadow, including ones beyond the target.
+	void run(const Geometry2d::Segment &target, const Geometry2d::Point &origin, float dist, ShadowWindowBuffer &out);
+
+
+	///	the origin the last run() evaluated from
+	///	note: this is the origin of the WindowCache entry that answered, which can be up to
+	///	WindowCache::OriginTolerance from the one that was passed in
+	Geometry2d::Point origin() const {
+		return _origin;
+	}
+
+
+	///	robots at these points aren't obstacles
+	std::vector<Geometry2d::Point> exclude;
+
+	bool debug;
+
+
+	///	Shadows of obstacles at (@x[i], @y[i]) on the view's target, in radians.
+	///	Obstacles that don't cast a shadow get a start and end of NoShadow.
+	static void computeShadows(const View &view, const float *x, const float *y, int n, float *start, float *end);
+
+	///	sorts the shadows and writes the gaps between them into @out
+	static void sweep(const View &view, const float *start, const float *end, int n, ShadowWindowBuffer &out);
+
+	static const float NoShadow;
+
+
+protected:
+	void evaluate(const Geometry2d::Point &origin, const Geometry2d::Segment &target, float maxDist, ShadowWindowBuffer &out);
+
+
+private:
+	SystemState *_state;
+	Geometry2d::Point _origin;
+};
@@ -0,0 +1,200 @@
+
+#include "ShotTarget.hpp"
+#include "OpponentPrediction.hpp"
+#include "FieldModel.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace Geometry2d;
+
+
+
+REGISTER_CONFIGURABLE(ShotTarget)
+
+ConfigDouble *ShotTarget::_angle_noise;
+
+float ShotTarget::_noise[NoiseSamples];
+bool ShotTarget::_noiseReady = false;
+
+
+
+void ShotTarget::createConfiguration(Configuration *cfg)
+{
+	_angle_noise = new ConfigDouble(cfg, "Shot/Angle Noise - Deg", 3.0);
+}
+
+
+
+//	wraps an angle to [-pi, pi)
+static float wrapAngle(float a) {
+	return a - 2 * M_PI * floor((a + M_PI) / (2 * M_PI));
+}
+
+
+
+ShotTarget::ShotTarget(const Point &origin, const Point &post0, const Point &post1) {
+	_origin = origin;
+	_post0 = post0;
+	_post1 = post1;
+
+	_post0Angle = (post0 - origin).angle();
+	float span = wrapAngle((post1 - origin).angle() - _post0Angle);
+	_sign = span < 0 ? -1 : 1;
+	_span = span * _sign;
+
+	_mouth = post1 - post0;
+	_offset = (post0 - origin).cross(_mouth);
+
+	_shadowCount = 0;
+	_openCount = 0;
+
+	if ( !_noiseReady ) {
+		//	fixed quasi-random samples through Box-Muller so results are repeatable
+		for ( int i = 0; i < NoiseSamples; i += 2 ) {
+			float u1 = (i + 0.5f) / NoiseSamples;
+			float u2 = fmod(i * 0.618034f, 1.0f);
+			float r = sqrt(-2 * log(u1));
+			_noise[i] = r * cos(2 * M_PI * u2);
+			if ( i + 1 < NoiseSamples ) _noise[i + 1] = r * sin(2 * M_PI * u2);
+		}
+		_noiseReady = true;
+	}
+}
+
+
+
+ShotTarget ShotTarget::atOpponentGoal(SystemState *state, const Point &origin) {
+	const Segment &goal = Field::instance().theirGoalLine();
+	ShotTarget shot(origin, goal.pt[0], goal.pt[1]);
+
+	const OpponentPrediction &prediction = OpponentPrediction::forState(state);
+	for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+		if ( (prediction.visible >> i) & 1 ) {
+			shot.addObstacle(prediction.pos(i, OpponentPrediction::Horizon300ms));
+		}
+	}
+
+	shot.run();
+	return shot;
+}
+
+
+
+void ShotTarget::addObstacle(const Point &pos, float radius) {
+	if ( _shadowCount >= MaxObstacles ) return;
+
+	Point delta = pos - _origin;
+	float dist = delta.mag();
+	if ( dist <= radius ) return;
+
+	//	the ray through the obstacle meets the goal line at origin + delta * along, so the
+	//	obstacle is in front of the line if along > 1
+	float rate = delta.cross(_mouth);
+	if ( rate == 0 || _offset / rate <= 1 ) return;
+
+	float center = wrapAngle(delta.angle() - _post0Angle) * _sign;
+	float halfWidth = asin(radius / dist);
+
+	_shadowStart[_shadowCount] = center - halfWidth;
+	_shadowEnd[_shadowCount] = center + halfWidth;
+	_shadowCount++;
+}
+
+
+
+void ShotTarget::run() {
+	//	sort the shadows by where they start
+	int order[MaxObstacles];
+	for ( int i = 0; i < _shadowCount; i++ ) order[i] = i;
+	for ( int i = 1; i < _shadowCount; i++ ) {
+		int o = order[i];
+		int j = i;
+		while ( j > 0 && _shadowStart[order[j - 1]] > _shadowStart[o] ) {
+			order[j] = order[j - 1];
+			j--;
+		}
+		order[j] = o;
+	}
+
+	//	sweep, emitting the gaps between shadows
+	_openCount = 0;
+	float covered = 0;
+	for ( int k = 0; k < _shadowCount && covered < _span; k++ ) {
+		int i = order[k];
+		if ( _shadowStart[i] > covered ) {
+			_open[_openCount].start = covered;
+			_open[_openCount].end = min(_shadowStart[i], _span);
+			_openCount++;
+		}
+		covered = max(covered, _shadowEnd[i]);
+	}
+	if ( covered < _span ) {
+		_open[_openCount].start = covered;
+		_open[_openCount].end = _span;
+		_openCount++;
+	}
+}
+
+
+
+float ShotTarget::largestOpenAngle() const {
+	float best = 0;
+	for ( int i = 0; i < _openCount; i++ ) {
+		best = max(best, _open[i].width());
+	}
+	return best;
+}
+
+
+
+Point ShotTarget::pointAt(float angle) const {
+	Point dir = Point::direction(_post0Angle + _sign * angle);
+	Point mouth = _post1 - _post0;
+
+	float denom = dir.cross(mouth);
+	if ( denom == 0 ) return _post0;
+
+	float t = (_post0 - _origin).cross(mouth) / denom;
+	return _origin + dir * t;
+}
+
+
+
+float ShotTarget::successProbability(float angle) const {
+	const float sigma = *_angle_noise * DegreesToRadians;
+
+	int hits = 0;
+	for ( int i = 0; i < _openCount; i++ ) {
+		const float start = _open[i].start;
+		const float end = _open[i].end;
+		for ( int k = 0; k < NoiseSamples; k++ ) {
+			float a = angle + sigma * _noise[k];
+			hits += (a >= start) & (a <= end);
+		}
+	}
+
+	return (float)hits / NoiseSamples;
+}
+
+
+
+bool ShotTarget::best(Point &target, float *probability) const {
+	int bestInterval = -1;
+	float bestProbability = 0;
+
+	for ( int i = 0; i < _openCount; i++ ) {
+		float p = successProbability(_open[i].center());
+		if ( bestInterval < 0 || p > bestProbability ) {
+			bestInterval = i;
+			bestProbability = p;
+		}
+	}
+
+	if ( bestInterval < 0 ) return false;
+
+	target = pointAt(_open[bestInterval].center());
+	if ( probability ) *probability = bestProbability;
+	return true;
+}
@@ -0,0 +1,125 @@
+
+#pragma once
+
+#include "Configuration.hpp"
+#include "WorldSnapshot.hpp"
+
+#include <Constants.hpp>
+#include <Geometry2d/Point.hpp>
+
+
+/**
+ *	Finds where to aim a shot on a goal mouth as seen from a kick point.
+ *
+ *	Each obstacle casts an angular shadow on the segment between the posts.  The shadows
+ *	are sorted and swept to find the open intervals, and each interval's center is scored
+ *	by the fraction of a fixed set of normally distributed kick-angle errors that still land
+ *	in an open interval.  The whole thing is a few microseconds, so skills can ask every frame.
+ *
+ *	Angles are measured from the direction of the first post toward the second, so 0 is the
+ *	first post and span() is the second.
+ */
+class ShotTarget {
+public:
+	static void createConfiguration(Configuration *cfg);
+
+
+	///	most obstacles a ShotTarget considers
+	static const int MaxObstacles = 2 * WorldSnapshot::MaxRobots;
+
+	///	number of kick-noise samples used to estimate success
+	static const int NoiseSamples = 64;
+
+
+	///	range of angles, in radians from the first post, that's clear
+	class Interval {
+	public:
+		float start;
+		float end;
+
+		float width() const {
+			return end - start;
+		}
+
+		float center() const {
+			return (start + end) / 2;
+		}
+	};
+
+
+	ShotTarget(const Geometry2d::Point &origin, const Geometry2d::Point &post0, const Geometry2d::Point &post1);
+
+
+	///	a ShotTarget looking at the opponent's goal from @origin, blocked by the opponents
+	///	predicted 0.3s ahead
+	static ShotTarget atOpponentGoal(SystemState *state, const Geometry2d::Point &origin);
+
+
+	///	obstacles past the goal line along their own direction from the origin, or covering the
+	///	origin, are ignored
+	void addObstacle(const Geometry2d::Point &pos, float radius = Robot_Radius);
+
+
+	///	computes the open intervals.  Call after adding obstacles.
+	void run();
+
+
+	///	angle between the posts in radians
+	float span() const {
+		return _span;
+	}
+
+	int openCount() const {
+		return _openCount;
+	}
+
+	const Interval &open(int i) const {
+		return _open[i];
+	}
+
+	///	width in radians of the widest open interval, 0 if the goal is completely blocked
+	float largestOpenAngle() const;
+
+
+	///	point on the goal mouth in the direction @angle radians from the first post
+	Geometry2d::Point pointAt(float angle) const;
+
+
+	///	fraction of noisy kicks aimed at @angle that go in
+	float successProbability(float angle) const;
+
+
+	///	Picks the open interval whose center has the best chance of going in.
+	///	Returns false if the goal is completely blocked.
+	bool best(Geometry2d::Point &target, float *probability = NULL) const;
+
+
+private:
+	Geometry2d::Point _origin;
+	Geometry2d::Point _post0;
+	Geometry2d::Point _post1;
+
+	float _post0Angle;
+	float _span;
+
+	///	+1 if angles increase counterclockwise from the first post, -1 otherwise
+	float _sign;
+
+	///	post1 - post0, and (post0 - origin) x mouth, for distances along rays to the goal line
+	Geometry2d::Point _mouth;
+	float _offset;
+
+	float _shadowStart[MaxObstacles];
+	float _shadowEnd[MaxObstacles];
+	int _shadowCount;
+
+	Interval _open[MaxObstacles + 1];
+	int _openCount;
+
+
+	static ConfigDouble *_angle_noise;
+
+	///	standard normal samples, the same every run
+	static float _noise[NoiseSamples];
+	static bool _noiseReady;
+};
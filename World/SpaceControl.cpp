@@ -0,0 +1,235 @@
+
+#include "SpaceControl.hpp"
+#include "InterceptSolver.hpp"
+#include "MotionModel.hpp"
+
+#include <Constants.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace Geometry2d;
+
+
+
+REGISTER_CONFIGURABLE(SpaceControl)
+
+ConfigDouble *SpaceControl::_resolution;
+ConfigDouble *SpaceControl::_move_threshold;
+ConfigDouble *SpaceControl::_velocity_threshold;
+
+const int SpaceControl::NoOwner;
+
+PerFrame<SpaceControl> SpaceControl::_current;
+
+
+//	arrival time for robots that aren't on the field
+static const float NoTime = 1e9;
+
+
+
+void SpaceControl::createConfiguration(Configuration *cfg)
+{
+	_resolution = new ConfigDouble(cfg, "Space/Grid Resolution", 0.2);
+	_move_threshold = new ConfigDouble(cfg, "Space/Move Threshold", 0.02);
+	_velocity_threshold = new ConfigDouble(cfg, "Space/Velocity Threshold", 0.05);
+}
+
+
+
+SpaceControl::SpaceControl() {
+	_visible[Us] = _visible[Them] = 0;
+	_valid = false;
+
+	for ( int t = 0; t < 2; t++ ) {
+		for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+			_cellCount[t][i] = 0;
+			_x[t][i] = _y[t][i] = 0;
+			_vx[t][i] = _vy[t][i] = 0;
+		}
+	}
+}
+
+
+
+const SpaceControl &SpaceControl::forState(SystemState *state) {
+	return _current.get(state, &SpaceControl::update);
+}
+
+
+
+void SpaceControl::layout(float resolution) {
+	_grid.resize(resolution);
+	const int cells = _grid.size();
+
+	_cx.resize(cells);
+	_cy.resize(cells);
+	for ( int c = 0; c < cells; c++ ) {
+		Point center = _grid.center(c);
+		_cx[c] = center.x;
+		_cy[c] = center.y;
+	}
+
+	for ( int t = 0; t < 2; t++ ) {
+		_time[t].assign(cells * WorldSnapshot::MaxRobots, NoTime);
+		_best[t].assign(cells, NoTime);
+		_bestRobot[t].assign(cells, NoOwner);
+		_visible[t] = 0;
+	}
+
+	_ownedSum[Us].assign((_grid.cols() + 1) * (_grid.rows() + 1), 0);
+	_ownedSum[Them].assign((_grid.cols() + 1) * (_grid.rows() + 1), 0);
+	_valid = false;
+}
+
+
+
+void SpaceControl::updateTimes(Team team, int robot, const WorldSnapshot::Team &robots) {
+	const int cells = _grid.size();
+	float *time = &_time[team][robot * cells];
+
+	const float rx = robots.x[robot];
+	const float ry = robots.y[robot];
+	const float vx = robots.vx[robot];
+	const float vy = robots.vy[robot];
+
+	//	both teams are assumed to move like ours
+	const float maxAccel = InterceptSolver::maxAccel();
+	const float maxSpeed = InterceptSolver::maxSpeed();
+
+	for ( int c = 0; c < cells; c++ ) {
+		float dx = _cx[c] - rx;
+		float dy = _cy[c] - ry;
+		float dist = sqrtf(dx * dx + dy * dy);
+		float v0 = dist > 0 ? (vx * dx + vy * dy) / dist : 0;
+		time[c] = MotionModel::travelTime(dist, v0, maxAccel, maxSpeed);
+	}
+}
+
+
+
+void SpaceControl::assign(Team team, int robot) {
+	const int cells = _grid.size();
+	const float *time = &_time[team][robot * cells];
+	float *best = &_best[team][0];
+	int *bestRobot = &_bestRobot[team][0];
+
+	for ( int c = 0; c < cells; c++ ) {
+		if ( bestRobot[c] == robot ) {
+			//	the robot may have fallen behind a teammate - recompute this cell from scratch
+			float b = NoTime;
+			int br = NoOwner;
+			for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+				float t = _time[team][i * cells + c];
+				if ( t < b ) {
+					b = t;
+					br = i;
+				}
+			}
+			best[c] = b;
+			bestRobot[c] = br;
+		} else if ( time[c] < best[c] || (time[c] == best[c] && time[c] < NoTime && robot < bestRobot[c]) ) {
+			//	ties go to the lower index, same as the rebuild above
+			best[c] = time[c];
+			bestRobot[c] = robot;
+		}
+	}
+}
+
+
+
+void SpaceControl::update(const WorldSnapshot &world) {
+	if ( !_valid || _grid.cellSize() != (float)*_resolution ) {
+		layout(*_resolution);
+	}
+
+	const int cells = _grid.size();
+	const float threshSq = *_move_threshold * *_move_threshold;
+	const float velThreshSq = *_velocity_threshold * *_velocity_threshold;
+	bool changed = !_valid;
+
+	const WorldSnapshot::Team *teams[2] = { &world.us, &world.them };
+	for ( int t = 0; t < 2; t++ ) {
+		const WorldSnapshot::Team &robots = *teams[t];
+
+		for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+			bool visible = i < robots.count && robots.isVisible(i);
+			bool wasVisible = (_visible[t] >> i) & 1;
+
+			if ( visible ) {
+				//	arrival times depend on the velocity too, so a robot starting or stopping in place
+				//	needs its column redone
+				float dx = robots.x[i] - _x[t][i];
+				float dy = robots.y[i] - _y[t][i];
+				float dvx = robots.vx[i] - _vx[t][i];
+				float dvy = robots.vy[i] - _vy[t][i];
+				if ( wasVisible && dx * dx + dy * dy <= threshSq && dvx * dvx + dvy * dvy <= velThreshSq ) continue;
+
+				_x[t][i] = robots.x[i];
+				_y[t][i] = robots.y[i];
+				_vx[t][i] = robots.vx[i];
+				_vy[t][i] = robots.vy[i];
+				updateTimes((Team)t, i, robots);
+			} else if ( wasVisible ) {
+				fill(_time[t].begin() + i * cells, _time[t].begin() + (i + 1) * cells, NoTime);
+			} else {
+				continue;
+			}
+
+			assign((Team)t, i);
+			changed = true;
+		}
+
+		_visible[t] = robots.visible;
+	}
+
+	_valid = true;
+	if ( changed ) recount();
+}
+
+
+
+void SpaceControl::recount() {
+	const int cols = _grid.cols();
+	const int stride = cols + 1;
+
+	for ( int t = 0; t < 2; t++ ) {
+		for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) _cellCount[t][i] = 0;
+	}
+
+	for ( int row = 0; row < _grid.rows(); row++ ) {
+		for ( int col = 0; col < cols; col++ ) {
+			int c = row * cols + col;
+			Team team = _best[Us][c] <= _best[Them][c] ? Us : Them;
+			int owner = _bestRobot[team][c];
+			if ( owner != NoOwner ) _cellCount[team][owner]++;
+
+			//	cells nobody can reach don't count for either team
+			for ( int t = 0; t < 2; t++ ) {
+				vector<int> &sums = _ownedSum[t];
+				sums[(row + 1) * stride + col + 1] = (t == team && owner != NoOwner)
+												   + sums[row * stride + col + 1]
+												   + sums[(row + 1) * stride + col]
+												   - sums[row * stride + col];
+			}
+		}
+	}
+}
+
+
+
+float SpaceControl::area(Team team, const Rect &region) const {
+	int c0, r0, c1, r1;
+	if ( !_grid.cellRange(region, c0, r0, c1, r1) ) return 0;
+
+	const vector<int> &sums = _ownedSum[team];
+	const int stride = _grid.cols() + 1;
+	int owned = sums[(r1 + 1) * stride + c1 + 1]
+			  - sums[r0 * stride + c1 + 1]
+			  - sums[(r1 + 1) * stride + c0]
+			  + sums[r0 * stride + c0];
+
+	const float size = _grid.cellSize();
+	return owned * size * size;
+}
@@ -0,0 +1,127 @@
+
+#pragma once
+
+#include "Configuration.hpp"
+#include "WorldSnapshot.hpp"
+#include "FieldGrid.hpp"
+#include "PerFrame.hpp"
+
+#include <Geometry2d/Rect.hpp>
+
+#include <vector>
+
+
+/**
+ *	Time-weighted Voronoi partition of the field between both teams.
+ *
+ *	Each cell of a raster over the field belongs to the robot that can get there first, using
+ *	the same trapezoidal motion model as the InterceptSolver, so a robot already moving toward
+ *	a region owns more of it than its distance alone would suggest.
+ *
+ *	Arrival times are stored per robot per cell, and each cell remembers the fastest robot of
+ *	each team.  When a robot moves or changes velocity by more than a threshold, only its column
+ *	is recomputed.  Then, for each cell, if the robot was that cell's fastest teammate, the team
+ *	minimum is recomputed.  Otherwise its new time is only compared against the stored minimum.
+ *	The result is the same as a full rebuild from the positions and velocities the columns were
+ *	last computed with, which are within the thresholds of the current ones.
+ */
+class SpaceControl {
+public:
+	static void createConfiguration(Configuration *cfg);
+
+
+	typedef enum {
+		Us = 0,
+		Them = 1
+	} Team;
+
+	///	owner of a cell that no visible robot can reach
+	static const int NoOwner = -1;
+
+
+	SpaceControl();
+
+
+	///	returns the partition for the current frame, updating it if this is the first call of the frame
+	static const SpaceControl &forState(SystemState *state);
+
+
+	void update(const WorldSnapshot &world);
+
+
+	const FieldGrid &grid() const {
+		return _grid;
+	}
+
+
+	///	team that gets to @pt first
+	Team team(const Geometry2d::Point &pt) const {
+		int c = _grid.index(pt);
+		return _best[Us][c] <= _best[Them][c] ? Us : Them;
+	}
+
+	///	index of the robot, into WorldSnapshot::us or WorldSnapshot::them depending on team(), that
+	///	gets to @pt first, or NoOwner
+	int owner(const Geometry2d::Point &pt) const {
+		int c = _grid.index(pt);
+		return _bestRobot[team(pt)][c];
+	}
+
+	///	seconds the opponents need to get to @pt minus the seconds we need.  Positive means ours.
+	float margin(const Geometry2d::Point &pt) const {
+		int c = _grid.index(pt);
+		return _best[Them][c] - _best[Us][c];
+	}
+
+
+	///	area in square meters owned by robot @i of @team
+	float area(Team team, int i) const {
+		return _cellCount[team][i] * _grid.cellSize() * _grid.cellSize();
+	}
+
+	///	area in square meters of the cells in @region, with centers inside it, that @team controls
+	float area(Team team, const Geometry2d::Rect &region) const;
+
+
+protected:
+	void layout(float resolution);
+
+	void updateTimes(Team team, int robot, const WorldSnapshot::Team &robots);
+	void assign(Team team, int robot);
+	void recount();
+
+
+private:
+	FieldGrid _grid;
+
+	//	cell centers
+	std::vector<float> _cx;
+	std::vector<float> _cy;
+
+	///	_time[team][robot * cells + cell] = seconds for the robot to get to the cell
+	std::vector<float> _time[2];
+
+	///	fastest time and robot of each team per cell
+	std::vector<float> _best[2];
+	std::vector<int> _bestRobot[2];
+
+	int _cellCount[2][WorldSnapshot::MaxRobots];
+
+	///	summed-area tables of the cells each team controls, (rows + 1) x (cols + 1)
+	std::vector<int> _ownedSum[2];
+
+	//	what the stored columns were computed from
+	float _x[2][WorldSnapshot::MaxRobots];
+	float _y[2][WorldSnapshot::MaxRobots];
+	float _vx[2][WorldSnapshot::MaxRobots];
+	float _vy[2][WorldSnapshot::MaxRobots];
+	uint32_t _visible[2];
+	bool _valid;
+
+
+	static ConfigDouble *_resolution;
+	static ConfigDouble *_move_threshold;
+	static ConfigDouble *_velocity_threshold;
+
+	static PerFrame<SpaceControl> _current;
+};
@@ -0,0 +1,234 @@
+
+#include "SpatialIndex.hpp"
+
+#include <Constants.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace Geometry2d;
+
+
+
+const float SpatialIndex::CellSize = 0.5;
+const float SpatialIndex::Margin = 0.5;
+
+PerFrame<SpatialIndex> SpatialIndex::_current;
+
+
+//	most entries a nearest() query can return: two teams and the ball
+static const int MaxNearest = 2 * WorldSnapshot::MaxRobots + 1;
+
+
+
+SpatialIndex::SpatialIndex() {
+	_minX = -Field_Width / 2 - Margin;
+	_minY = -Margin;
+	_cols = (int)ceil((Field_Width + 2 * Margin) / CellSize);
+	_rows = (int)ceil((Field_Length + 2 * Margin) / CellSize);
+
+	_cellStart.resize(_cols * _rows + 1, 0);
+	_cursor.resize(_cols * _rows, 0);
+	_entries.reserve(MaxNearest);
+}
+
+
+
+const SpatialIndex &SpatialIndex::forState(SystemState *state) {
+	return _current.get(state, &SpatialIndex::build);
+}
+
+
+
+int SpatialIndex::cellX(float x) const {
+	int cx = (int)floor((x - _minX) / CellSize);
+	return max(0, min(_cols - 1, cx));
+}
+
+int SpatialIndex::cellY(float y) const {
+	int cy = (int)floor((y - _minY) / CellSize);
+	return max(0, min(_rows - 1, cy));
+}
+
+
+
+void SpatialIndex::build(const WorldSnapshot &world) {
+	//	gather everything that's visible
+	Entry unsorted[MaxNearest];
+	int cells[MaxNearest];
+	int count = 0;
+
+	for ( int i = 0; i < world.us.count; i++ ) {
+		if ( !world.us.isVisible(i) ) continue;
+		unsorted[count].kind = KindUs;
+		unsorted[count].index = i;
+		unsorted[count].pos = world.us.pos(i);
+		count++;
+	}
+	for ( int i = 0; i < world.them.count; i++ ) {
+		if ( !world.them.isVisible(i) ) continue;
+		unsorted[count].kind = KindThem;
+		unsorted[count].index = i;
+		unsorted[count].pos = world.them.pos(i);
+		count++;
+	}
+	unsorted[count].kind = KindBall;
+	unsorted[count].index = -1;
+	unsorted[count].pos = world.ballPos;
+	count++;
+
+
+	//	counting sort by cell
+	fill(_cellStart.begin(), _cellStart.end(), 0);
+	for ( int i = 0; i < count; i++ ) {
+		cells[i] = cellIndex(cellX(unsorted[i].pos.x), cellY(unsorted[i].pos.y));
+		_cellStart[cells[i] + 1]++;
+	}
+	for ( int c = 0; c < _cols * _rows; c++ ) {
+		_cellStart[c + 1] += _cellStart[c];
+	}
+
+	_entries.resize(count);
+	_cursor.assign(_cellStart.begin(), _cellStart.end() - 1);
+	for ( int i = 0; i < count; i++ ) {
+		_entries[_cursor[cells[i]]++] = unsorted[i];
+	}
+}
+
+
+
+int SpatialIndex::nearest(const Point &pt, int kinds, int k, Entry *out, const Rect *within) const {
+	k = min(k, MaxNearest);
+	if ( k <= 0 ) return 0;
+
+	float distSq[MaxNearest];
+	int found = 0;
+
+	//	the ring bound below only holds if the query point is inside the grid
+	bool inGrid = pt.x >= _minX && pt.x < _minX + _cols * CellSize &&
+				  pt.y >= _minY && pt.y < _minY + _rows * CellSize;
+
+	int cx = cellX(pt.x);
+	int cy = cellY(pt.y);
+	int maxRing = max(_cols, _rows);
+
+	for ( int ring = 0; ring <= maxRing; ring++ ) {
+		for ( int y = cy - ring; y <= cy + ring; y++ ) {
+			if ( y < 0 || y >= _rows ) continue;
+
+			//	only visit the border of the ring
+			bool edgeRow = (y == cy - ring || y == cy + ring);
+			int step = edgeRow ? 1 : 2 * ring;
+
+			for ( int x = cx - ring; x <= cx + ring; x += max(step, 1) ) {
+				if ( x < 0 || x >= _cols ) continue;
+
+				int c = cellIndex(x, y);
+				for ( int e = _cellStart[c]; e < _cellStart[c + 1]; e++ ) {
+					const Entry &entry = _entries[e];
+					if ( !(entry.kind & kinds) ) continue;
+					if ( within && !within->contains(entry.pos) ) continue;
+
+					float d = (entry.pos - pt).magsq();
+					if ( found == k && d >= distSq[k - 1] ) continue;
+
+					//	insertion sort into the results
+					int slot = (found < k) ? found++ : k - 1;
+					while ( slot > 0 && distSq[slot - 1] > d ) {
+						distSq[slot] = distSq[slot - 1];
+						out[slot] = out[slot - 1];
+						slot--;
+					}
+					distSq[slot] = d;
+					out[slot] = entry;
+				}
+			}
+		}
+
+		//	everything in the remaining rings is at least ring * CellSize away
+		float bound = ring * CellSize;
+		if ( inGrid && found == k && distSq[k - 1] <= bound * bound ) break;
+	}
+
+	return found;
+}
+
+
+
+void SpatialIndex::inRect(const Rect &rect, int kinds, vector<Entry> &out) const {
+	int x0 = cellX(min(rect.pt[0].x, rect.pt[1].x));
+	int x1 = cellX(max(rect.pt[0].x, rect.pt[1].x));
+	int y0 = cellY(min(rect.pt[0].y, rect.pt[1].y));
+	int y1 = cellY(max(rect.pt[0].y, rect.pt[1].y));
+
+	for ( int y = y0; y <= y1; y++ ) {
+		for ( int x = x0; x <= x1; x++ ) {
+			int c = cellIndex(x, y);
+			for ( int e = _cellStart[c]; e < _cellStart[c + 1]; e++ ) {
+				const Entry &entry = _entries[e];
+				if ( (entry.kind & kinds) && rect.contains(entry.pos) ) out.push_back(entry);
+			}
+		}
+	}
+}
+
+
+
+void SpatialIndex::inCircle(const Point &center, float radius, int kinds, vector<Entry> &out) const {
+	int x0 = cellX(center.x - radius);
+	int x1 = cellX(center.x + radius);
+	int y0 = cellY(center.y - radius);
+	int y1 = cellY(center.y + radius);
+	float radiusSq = radius * radius;
+
+	for ( int y = y0; y <= y1; y++ ) {
+		for ( int x = x0; x <= x1; x++ ) {
+			int c = cellIndex(x, y);
+			for ( int e = _cellStart[c]; e < _cellStart[c + 1]; e++ ) {
+				const Entry &entry = _entries[e];
+				if ( (entry.kind & kinds) && (entry.pos - center).magsq() <= radiusSq ) out.push_back(entry);
+			}
+		}
+	}
+}
+
+
+
+void SpatialIndex::inCorridor(const Segment &segment, float radius, int kinds, vector<Entry> &out) const {
+	int x0 = cellX(min(segment.pt[0].x, segment.pt[1].x) - radius);
+	int x1 = cellX(max(segment.pt[0].x, segment.pt[1].x) + radius);
+	int y0 = cellY(min(segment.pt[0].y, segment.pt[1].y) - radius);
+	int y1 = cellY(max(segment.pt[0].y, segment.pt[1].y) + radius);
+
+	for ( int y = y0; y <= y1; y++ ) {
+		for ( int x = x0; x <= x1; x++ ) {
+			int c = cellIndex(x, y);
+			for ( int e = _cellStart[c]; e < _cellStart[c + 1]; e++ ) {
+				const Entry &entry = _entries[e];
+				if ( (entry.kind & kinds) && segment.distTo(entry.pos) <= radius ) out.push_back(entry);
+			}
+		}
+	}
+}
+
+
+
+bool SpatialIndex::corridorClear(const Segment &segment, float radius, int kinds) const {
+	int x0 = cellX(min(segment.pt[0].x, segment.pt[1].x) - radius);
+	int x1 = cellX(max(segment.pt[0].x, segment.pt[1].x) + radius);
+	int y0 = cellY(min(segment.pt[0].y, segment.pt[1].y) - radius);
+	int y1 = cellY(max(segment.pt[0].y, segment.pt[1].y) + radius);
+
+	for ( int y = y0; y <= y1; y++ ) {
+		for ( int x = x0; x <= x1; x++ ) {
+			int c = cellIndex(x, y);
+			for ( int e = _cellStart[c]; e < _cellStart[c + 1]; e++ ) {
+				const Entry &entry = _entries[e];
+				if ( (entry.kind & kinds) && segment.distTo(entry.pos) <= radius ) return false;
+			}
+		}
+	}
+
+	return true;
+}
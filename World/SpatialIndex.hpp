@@ -0,0 +1,115 @@
+
+#pragma once
+
+#include "WorldSnapshot.hpp"
+#include "PerFrame.hpp"
+
+#include <Geometry2d/Point.hpp>
+#include <Geometry2d/Segment.hpp>
+#include <Geometry2d/Rect.hpp>
+
+#include <vector>
+
+
+/**
+ *	Uniform grid over the field holding both teams and the ball, rebuilt once per frame.
+ *
+ *	Queries such as "nearest visible opponent to the ball inside this Rect" or "is this
+ *	corridor clear" used to be linear scans repeated by every Action that asked.  The grid
+ *	is shared by all Actions through Action::spatialIndex() and only looks at the cells a
+ *	query overlaps.
+ *
+ *	Only visible robots are inserted.  Positions come from the WorldSnapshot of the same frame.
+ */
+class SpatialIndex {
+public:
+
+	///	bit flags selecting which objects a query considers
+	typedef enum {
+		KindUs		= 1,
+		KindThem	= 2,
+		KindBall	= 4,
+		KindRobots	= KindUs | KindThem,
+		KindAll		= KindUs | KindThem | KindBall
+	} Kind;
+
+
+	///	an object in the index
+	class Entry {
+	public:
+		Kind kind;
+
+		///	index into WorldSnapshot::us or WorldSnapshot::them, -1 for the ball
+		int index;
+
+		Geometry2d::Point pos;
+	};
+
+
+	///	side length of a grid cell in meters
+	static const float CellSize;
+
+	///	how far past the field lines the grid extends.  Anything outside is clamped to the edge cells.
+	static const float Margin;
+
+
+	SpatialIndex();
+
+
+	///	returns the index for the current frame, building it if this is the first call of the frame
+	static const SpatialIndex &forState(SystemState *state);
+
+
+	void build(const WorldSnapshot &world);
+
+
+	///	Finds up to @k objects of the given kinds closest to @pt, nearest first.
+	///	If @within is given, only objects inside it are considered.
+	///	Returns the number of entries written to @out.
+	int nearest(const Geometry2d::Point &pt, int kinds, int k, Entry *out, const Geometry2d::Rect *within = NULL) const;
+
+
+	///	convenience for the k = 1 case.  Returns false if nothing matched.
+	bool nearest(const Geometry2d::Point &pt, int kinds, Entry &out, const Geometry2d::Rect *within = NULL) const {
+		return nearest(pt, kinds, 1, &out, within) == 1;
+	}
+
+
+	///	appends every object of the given kinds inside @rect to @out
+	void inRect(const Geometry2d::Rect &rect, int kinds, std::vector<Entry> &out) const;
+
+	///	appends every object of the given kinds within @radius of @center to @out
+	void inCircle(const Geometry2d::Point &center, float radius, int kinds, std::vector<Entry> &out) const;
+
+	///	appends every object of the given kinds within @radius of @segment to @out
+	void inCorridor(const Geometry2d::Segment &segment, float radius, int kinds, std::vector<Entry> &out) const;
+
+	///	true if no object of the given kinds is within @radius of @segment
+	bool corridorClear(const Geometry2d::Segment &segment, float radius, int kinds) const;
+
+
+protected:
+	int cellX(float x) const;
+	int cellY(float y) const;
+
+	int cellIndex(int cx, int cy) const {
+		return cy * _cols + cx;
+	}
+
+
+private:
+	int _cols;
+	int _rows;
+	float _minX;
+	float _minY;
+
+	///	entries sorted by cell.  The entries of cell c are [_cellStart[c], _cellStart[c + 1]).
+	std::vector<int> _cellStart;
+	std::vector<Entry> _entries;
+
+	///	scratch space for build()
+	std::vector<int> _cursor;
+
+
+	static PerFrame<SpatialIndex> _current;
+};
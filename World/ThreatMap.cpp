@@ -0,0 +1,238 @@
+
+#include "ThreatMap.hpp"
+
+#include <Constants.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace Geometry2d;
+
+
+
+REGISTER_CONFIGURABLE(ThreatMap)
+
+ConfigDouble *ThreatMap::_resolution;
+ConfigDouble *ThreatMap::_kernel_radius;
+ConfigDouble *ThreatMap::_goal_weight;
+
+PerFrame<ThreatMap> ThreatMap::_current;
+
+
+//	opponent weights are quantized to this many steps per unit so small moves don't restamp
+static const int WeightSteps = 16;
+
+
+
+void ThreatMap::createConfiguration(Configuration *cfg)
+{
+	_resolution = new ConfigDouble(cfg, "Threat/Grid Resolution", 0.25);
+	_kernel_radius = new ConfigDouble(cfg, "Threat/Kernel Radius", 1.0);
+	_goal_weight = new ConfigDouble(cfg, "Threat/Goal Weight", 2.0);
+}
+
+
+
+ThreatMap::ThreatMap() {
+	_radius = 0;
+	_dirtyCol = _dirtyRow = 0;
+}
+
+
+
+const ThreatMap &ThreatMap::forState(SystemState *state) {
+	return _current.get(state, &ThreatMap::update);
+}
+
+
+
+void ThreatMap::layout(float resolution, float radius) {
+	_grid.resize(resolution);
+	_radius = radius;
+
+	const int cells = _grid.size();
+	_threat.assign(cells, 0);
+	_coverage.assign(cells, 0);
+	_occupancy.assign(cells, 0);
+	_occupied.assign((cells + 31) / 32, 0);
+
+	const int sumSize = (_grid.cols() + 1) * (_grid.rows() + 1);
+	_threatSum.assign(sumSize, 0);
+	_coverageSum.assign(sumSize, 0);
+	_occupiedSum.assign(sumSize, 0);
+
+	//	linear falloff from the center of the cell out to the radius
+	_kernelDx.clear();
+	_kernelDy.clear();
+	_kernelValue.clear();
+	const int reach = (int)ceil(radius / resolution);
+	for ( int dy = -reach; dy <= reach; dy++ ) {
+		for ( int dx = -reach; dx <= reach; dx++ ) {
+			float d = sqrtf((float)(dx * dx + dy * dy)) * resolution;
+			if ( d >= radius ) continue;
+
+			_kernelDx.push_back(dx);
+			_kernelDy.push_back(dy);
+			_kernelValue.push_back((int)(Scale * (1 - d / radius) + 0.5f));
+		}
+	}
+
+	for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+		_them[i] = Stamp();
+		_us[i] = Stamp();
+	}
+
+	_dirtyCol = _dirtyRow = 0;
+}
+
+
+
+void ThreatMap::apply(vector<int> &layer, const Stamp &stamp, int sign) {
+	const int cols = _grid.cols();
+	const int rows = _grid.rows();
+	const int col = stamp.cell % cols;
+	const int row = stamp.cell / cols;
+
+	for ( int k = 0; k < _kernelValue.size(); k++ ) {
+		int x = col + _kernelDx[k];
+		int y = row + _kernelDy[k];
+		if ( x < 0 || x >= cols || y < 0 || y >= rows ) continue;
+
+		layer[y * cols + x] += sign * (_kernelValue[k] * stamp.weight / WeightSteps);
+	}
+
+	const int reach = (int)ceil(_radius / _grid.cellSize());
+	dirty(_grid.index(max(0, col - reach), max(0, row - reach)));
+}
+
+
+
+void ThreatMap::occupy(int cell, int delta) {
+	int before = _occupancy[cell];
+	_occupancy[cell] += delta;
+
+	if ( (before > 0) != (_occupancy[cell] > 0) ) {
+		_occupied[cell >> 5] ^= 1u << (cell & 31);
+		dirty(cell);
+	}
+}
+
+
+
+void ThreatMap::dirty(int cell) {
+	_dirtyCol = min(_dirtyCol, cell % _grid.cols());
+	_dirtyRow = min(_dirtyRow, cell / _grid.cols());
+}
+
+
+
+void ThreatMap::restamp(vector<int> &layer, Stamp &stamp, int cell, int weight) {
+	if ( stamp.cell == cell && stamp.weight == weight ) return;
+
+	if ( stamp.cell != cell ) {
+		if ( stamp.cell >= 0 ) occupy(stamp.cell, -1);
+		if ( cell >= 0 ) occupy(cell, 1);
+	}
+
+	if ( stamp.cell >= 0 ) apply(layer, stamp, -1);
+	stamp.cell = cell;
+	stamp.weight = weight;
+	if ( stamp.cell >= 0 ) apply(layer, stamp, 1);
+}
+
+
+
+void ThreatMap::update(const WorldSnapshot &world) {
+	if ( _grid.size() != _threat.size() || _grid.cellSize() != (float)*_resolution || _radius != (float)*_kernel_radius ) {
+		layout(*_resolution, *_kernel_radius);
+	}
+
+	//	nothing is dirty until a stamp changes
+	_dirtyCol = _grid.cols();
+	_dirtyRow = _grid.rows();
+
+	const float goalWeight = *_goal_weight;
+
+	for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+		bool visible = i < world.them.count && world.them.isVisible(i);
+		int cell = visible ? _grid.index(world.them.pos(i)) : -1;
+
+		//	opponents close to our goal count for more
+		float closeness = visible ? 1 - min(world.them.pos(i).mag() / Field_Length, 1.0f) : 0;
+		int weight = (int)((1 + goalWeight * closeness) * WeightSteps + 0.5f);
+
+		restamp(_threat, _them[i], cell, weight);
+	}
+
+	for ( int i = 0; i < WorldSnapshot::MaxRobots; i++ ) {
+		bool visible = i < world.us.count && world.us.isVisible(i);
+		int cell = visible ? _grid.index(world.us.pos(i)) : -1;
+
+		restamp(_coverage, _us[i], cell, WeightSteps);
+	}
+
+	if ( _dirtyCol < _grid.cols() && _dirtyRow < _grid.rows() ) {
+		refreshSums(_threat, _threatSum);
+		refreshSums(_coverage, _coverageSum);
+		refreshSums(_occupancy, _occupiedSum);
+	}
+}
+
+
+
+void ThreatMap::refreshSums(const vector<int> &layer, vector<int64_t> &sums) {
+	const int cols = _grid.cols();
+	const int stride = cols + 1;
+	const bool counts = &layer == &_occupancy;
+
+	//	entries above and to the left of the dirty corner only cover unchanged cells
+	for ( int row = _dirtyRow; row < _grid.rows(); row++ ) {
+		for ( int col = _dirtyCol; col < cols; col++ ) {
+			int v = layer[row * cols + col];
+			if ( counts ) v = v > 0;
+
+			sums[(row + 1) * stride + col + 1] = v
+											   + sums[row * stride + col + 1]
+											   + sums[(row + 1) * stride + col]
+											   - sums[row * stride + col];
+		}
+	}
+}
+
+
+
+int64_t ThreatMap::regionSum(const vector<int64_t> &sums, const Rect &region) const {
+	int c0, r0, c1, r1;
+	if ( !_grid.cellRange(region, c0, r0, c1, r1) ) return 0;
+
+	const int stride = _grid.cols() + 1;
+	return sums[(r1 + 1) * stride + c1 + 1]
+		 - sums[r0 * stride + c1 + 1]
+		 - sums[(r1 + 1) * stride + c0]
+		 + sums[r0 * stride + c0];
+}
+
+
+
+float ThreatMap::threat(const Rect &region) const {
+	return regionSum(_threatSum, region) / (float)Scale;
+}
+
+float ThreatMap::coverage(const Rect &region) const {
+	return regionSum(_coverageSum, region) / (float)Scale;
+}
+
+float ThreatMap::uncovered(const Rect &region) const {
+	return (regionSum(_threatSum, region) - regionSum(_coverageSum, region)) / (float)Scale;
+}
+
+int ThreatMap::occupiedCells(const Rect &region) const {
+	return (int)regionSum(_occupiedSum, region);
+}
+
+int ThreatMap::cells(const Rect &region) const {
+	int c0, r0, c1, r1;
+	if ( !_grid.cellRange(region, c0, r0, c1, r1) ) return 0;
+	return (c1 - c0 + 1) * (r1 - r0 + 1);
+}
@@ -0,0 +1,139 @@
+
+#pragma once
+
+#include "Configuration.hpp"
+#include "WorldSnapshot.hpp"
+#include "FieldGrid.hpp"
+#include "PerFrame.hpp"
+
+#include <Geometry2d/Rect.hpp>
+
+#include <vector>
+
+
+/**
+ *	Coarse rasters of opponent threat, our coverage, and occupancy over the field, kept up to
+ *	date incrementally and queried in constant time.
+ *
+ *	Every visible robot stamps a radial kernel centered on the cell it's in.  Opponent kernels
+ *	go into the threat layer, weighted more heavily the closer the opponent is to our goal, and
+ *	ours go into the coverage layer.  When a robot changes cells or its weight changes, its old
+ *	stamp is subtracted and the new one added, so only the cells around robots that moved are
+ *	touched.  Layers are stored in fixed point so adding and removing a stamp cancels exactly
+ *	and the layers never drift.
+ *
+ *	Summed-area tables over each layer are refreshed from the lowest dirty row and column, and
+ *	region queries read four entries of them.
+ */
+class ThreatMap {
+public:
+	static void createConfiguration(Configuration *cfg);
+
+
+	///	layer values are stored multiplied by this
+	static const int Scale = 1024;
+
+
+	ThreatMap();
+
+
+	///	returns the map for the current frame, updating it if this is the first call of the frame
+	static const ThreatMap &forState(SystemState *state);
+
+
+	void update(const WorldSnapshot &world);
+
+
+	const FieldGrid &grid() const {
+		return _grid;
+	}
+
+
+	///	threat in the cell containing @pt
+	float threat(const Geometry2d::Point &pt) const {
+		return _threat[_grid.index(pt)] / (float)Scale;
+	}
+
+	///	coverage by our robots in the cell containing @pt
+	float coverage(const Geometry2d::Point &pt) const {
+		return _coverage[_grid.index(pt)] / (float)Scale;
+	}
+
+	///	true if a visible robot of either team is in the cell containing @pt
+	bool occupied(const Geometry2d::Point &pt) const {
+		int c = _grid.index(pt);
+		return (_occupied[c >> 5] >> (c & 31)) & 1;
+	}
+
+
+	//	Region queries - sums over the cells whose centers are inside @region
+
+	float threat(const Geometry2d::Rect &region) const;
+	float coverage(const Geometry2d::Rect &region) const;
+
+	///	threat minus coverage - how much of the danger in @region is left unanswered
+	float uncovered(const Geometry2d::Rect &region) const;
+
+	///	number of cells in @region with a robot in them
+	int occupiedCells(const Geometry2d::Rect &region) const;
+
+	///	number of cells in @region
+	int cells(const Geometry2d::Rect &region) const;
+
+
+protected:
+	///	what a robot's current stamp was made with
+	class Stamp {
+	public:
+		Stamp() : cell(-1), weight(0) {}
+
+		int cell;		///	-1 if not stamped
+		int weight;		///	kernel multiplier, in 1/WeightSteps
+	};
+
+	void layout(float resolution, float radius);
+
+	void restamp(std::vector<int> &layer, Stamp &stamp, int cell, int weight);
+	void apply(std::vector<int> &layer, const Stamp &stamp, int sign);
+	void occupy(int cell, int delta);
+	void dirty(int cell);
+
+	void refreshSums(const std::vector<int> &layer, std::vector<int64_t> &sums);
+
+	///	sum of @sums over the cells whose centers are in @region, or 0 if there are none
+	int64_t regionSum(const std::vector<int64_t> &sums, const Geometry2d::Rect &region) const;
+
+
+private:
+	FieldGrid _grid;
+	float _radius;
+
+	//	kernel offsets and fixed point values
+	std::vector<int> _kernelDx;
+	std::vector<int> _kernelDy;
+	std::vector<int> _kernelValue;
+
+	std::vector<int> _threat;
+	std::vector<int> _coverage;
+	std::vector<int> _occupancy;
+	std::vector<uint32_t> _occupied;
+
+	//	summed-area tables, (rows + 1) x (cols + 1) with a zero border
+	std::vector<int64_t> _threatSum;
+	std::vector<int64_t> _coverageSum;
+	std::vector<int64_t> _occupiedSum;
+
+	//	lowest row and column changed since the sums were refreshed
+	int _dirtyCol;
+	int _dirtyRow;
+
+	Stamp _them[WorldSnapshot::MaxRobots];
+	Stamp _us[WorldSnapshot::MaxRobots];
+
+
+	static ConfigDouble *_resolution;
+	static ConfigDouble *_kernel_radius;
+	static ConfigDouble *_goal_weight;
+
+	static PerFrame<ThreatMap> _current;
+};
@@ -0,0 +1,200 @@
+
+#include "WindowCache.hpp"
+
+#include <cmath>
+#include <boost/foreach.hpp>
+
+using namespace std;
+using namespace Geometry2d;
+
+
+
+const float WindowCache::Quantum = 0.01;
+const float WindowCache::OriginTolerance = 0.02;
+const float WindowCache::MoveThreshold = 0.005;
+
+WindowCache::Entry WindowCache::_entries[WindowCache::MaxEntries];
+uint64_t WindowCache::_timestamp = 0;
+
+int WindowCache::_reused = 0;
+int WindowCache::_computed = 0;
+int WindowCache::_lookups = 0;
+int WindowCache::_hits = 0;
+
+
+//	robots within this distance of an exclude point are not obstacles
+static const float ExcludeTolerance = 0.001;
+
+
+
+static int quantize(float v) {
+	return (int)floor(v / WindowCache::Quantum + 0.5f);
+}
+
+
+
+//	bitmask of the robots in @team that are at one of the @exclude points
+static uint32_t excludedRobots(const WorldSnapshot::Team &team, const vector<Point> &exclude) {
+	uint32_t mask = 0;
+	for ( int i = 0; i < team.count; i++ ) {
+		BOOST_FOREACH(const Point &pt, exclude) {
+			if ( pt.nearPoint(team.pos(i), ExcludeTolerance) ) {
+				mask |= 1u << i;
+				break;
+			}
+		}
+	}
+	return mask;
+}
+
+
+
+const WindowCache::Entry &WindowCache::lookup(SystemState *state,
+											  const Point &origin,
+											  const Segment &target,
+											  float maxDist,
+											  const vector<Point> &exclude)
+{
+	const WorldSnapshot &world = WorldSnapshot::forState(state);
+
+	//	on a new frame, free anything nobody asked for last frame
+	if ( world.timestamp != _timestamp ) {
+		for ( int i = 0; i < MaxEntries; i++ ) {
+			if ( _entries[i].timestamp != _timestamp ) _entries[i].inUse = false;
+		}
+		_timestamp = world.timestamp;
+	}
+
+	_lookups++;
+
+
+	int qTarget[4] = { quantize(target.pt[0].x), quantize(target.pt[0].y), quantize(target.pt[1].x), quantize(target.pt[1].y) };
+	int qDist = maxDist < 0 ? -1 : quantize(maxDist);
+	uint32_t excludeUs = excludedRobots(world.us, exclude);
+	uint32_t excludeThem = excludedRobots(world.them, exclude);
+
+	//	an entry for the same question from close enough to the same place, or failing that one
+	//	for the same question that nobody has used yet this frame, which can be moved here
+	Entry *moveable = NULL;
+	Entry *oldest = NULL;
+	for ( int i = 0; i < MaxEntries; i++ ) {
+		Entry &entry = _entries[i];
+		if ( !entry.inUse ) {
+			if ( !oldest || oldest->inUse ) oldest = &entry;
+			continue;
+		}
+
+		if ( entry.qTarget[0] == qTarget[0] && entry.qTarget[1] == qTarget[1] &&
+			 entry.qTarget[2] == qTarget[2] && entry.qTarget[3] == qTarget[3] &&
+			 entry.qDist == qDist && entry.excludeUs == excludeUs && entry.excludeThem == excludeThem )
+		{
+			if ( entry.view.origin.nearPoint(origin, OriginTolerance) ) {
+				if ( entry.timestamp != world.timestamp ) update(entry, world);
+				_hits++;
+				return entry;
+			}
+
+			if ( !moveable && entry.timestamp != world.timestamp ) moveable = &entry;
+		}
+
+		if ( !oldest || (oldest->inUse && entry.timestamp < oldest->timestamp) ) oldest = &entry;
+	}
+
+
+	//	evaluate from scratch in the moveable entry, a free one, or the least recently used
+	Entry &entry = moveable ? *moveable : *oldest;
+
+	Point qo(quantize(origin.x) * Quantum, quantize(origin.y) * Quantum);
+	Segment qt(Point(qTarget[0] * Quantum, qTarget[1] * Quantum), Point(qTarget[2] * Quantum, qTarget[3] * Quantum));
+
+	entry.inUse = true;
+	entry.view = ShadowWindowEvaluator::View(qo, qt, qDist < 0 ? -1 : qDist * Quantum);
+	for ( int i = 0; i < 4; i++ ) entry.qTarget[i] = qTarget[i];
+	entry.qDist = qDist;
+	entry.excludeUs = excludeUs;
+	entry.excludeThem = excludeThem;
+	entry.count = 0;
+
+	update(entry, world);
+	return entry;
+}
+
+
+
+void WindowCache::update(Entry &entry, const WorldSnapshot &world) {
+	//	where each obstacle was in the entry's previous evaluation
+	int previous[2 * WorldSnapshot::MaxRobots];
+	for ( int i = 0; i < 2 * WorldSnapshot::MaxRobots; i++ ) previous[i] = -1;
+	for ( int k = 0; k < entry.count; k++ ) previous[entry.ids[k]] = k;
+
+	float x[ShadowWindowEvaluator::MaxObstacles];
+	float y[ShadowWindowEvaluator::MaxObstacles];
+	float start[ShadowWindowEvaluator::MaxObstacles];
+	float end[ShadowWindowEvaluator::MaxObstacles];
+	int ids[ShadowWindowEvaluator::MaxObstacles];
+	int count = 0;
+
+	//	obstacles that moved go in a second list to be recomputed in one batch
+	float movedX[ShadowWindowEvaluator::MaxObstacles];
+	float movedY[ShadowWindowEvaluator::MaxObstacles];
+	int movedSlot[ShadowWindowEvaluator::MaxObstacles];
+	int movedCount = 0;
+
+	const float threshSq = MoveThreshold * MoveThreshold;
+
+	const WorldSnapshot::Team *teams[2] = { &world.us, &world.them };
+	const uint32_t excluded[2] = { entry.excludeUs, entry.excludeThem };
+	for ( int t = 0; t < 2; t++ ) {
+		const WorldSnapshot::Team &team = *teams[t];
+		uint32_t obstacles = team.visible & ~excluded[t];
+
+		for ( int i = 0; i < team.count; i++ ) {
+			if ( !((obstacles >> i) & 1) ) continue;
+
+			int id = t * WorldSnapshot::MaxRobots + i;
+			int prev = previous[id];
+			ids[count] = id;
+
+			float dx = prev >= 0 ? team.x[i] - entry.x[prev] : 0;
+			float dy = prev >= 0 ? team.y[i] - entry.y[prev] : 0;
+			if ( prev >= 0 && dx * dx + dy * dy < threshSq ) {
+				//	keep the old shadow, and the position it was computed from
+				x[count] = entry.x[prev];
+				y[count] = entry.y[prev];
+				start[count] = entry.start[prev];
+				end[count] = entry.end[prev];
+				_reused++;
+			} else {
+				x[count] = team.x[i];
+				y[count] = team.y[i];
+				movedX[movedCount] = team.x[i];
+				movedY[movedCount] = team.y[i];
+				movedSlot[movedCount] = count;
+				movedCount++;
+			}
+			count++;
+		}
+	}
+
+	float movedStart[ShadowWindowEvaluator::MaxObstacles];
+	float movedEnd[ShadowWindowEvaluator::MaxObstacles];
+	ShadowWindowEvaluator::computeShadows(entry.view, movedX, movedY, movedCount, movedStart, movedEnd);
+	for ( int k = 0; k < movedCount; k++ ) {
+		start[movedSlot[k]] = movedStart[k];
+		end[movedSlot[k]] = movedEnd[k];
+	}
+	_computed += movedCount;
+
+	//	store the new obstacle set
+	for ( int k = 0; k < count; k++ ) {
+		entry.ids[k] = ids[k];
+		entry.x[k] = x[k];
+		entry.y[k] = y[k];
+		entry.start[k] = start[k];
+		entry.end[k] = end[k];
+	}
+	entry.count = count;
+
+	ShadowWindowEvaluator::sweep(entry.view, entry.start, entry.end, count, entry.windows);
+	entry.timestamp = world.timestamp;
+}
@@ -0,0 +1,118 @@
+
+#pragma once
+
+#include "ShadowWindowEvaluator.hpp"
+
+#include <vector>
+
+
+/**
+ *	Window evaluations shared by all Actions in a frame and carried over between frames.
+ *
+ *	Fullbacks usually look at the same goal line from nearly the same point with the same robots
+ *	excluded, so a ShadowWindowEvaluator asks the cache first.  Evaluations are keyed on the
+ *	target quantized to Quantum, the obstacle mode, and the set of excluded robots.  An entry
+ *	answers for any origin within OriginTolerance of the one its shadows were computed from, so
+ *	an origin that drifts a little each frame, like a predicted ball position, still hits.
+ *	A second request in a frame just gets the stored windows.
+ *
+ *	An entry that was used last frame is updated incrementally: each obstacle that moved less
+ *	than MoveThreshold keeps its stored shadow, and only the rest are recomputed before the
+ *	sweep.  If the origin has moved out of tolerance, every shadow changes, so the entry is
+ *	moved to the new origin and recomputed in place.
+ *
+ *	Entries live in a fixed table of MaxEntries.  Entries that go a frame without being used
+ *	are freed, and when the table is full the least recently used one is overwritten.
+ */
+class WindowCache {
+public:
+	///	target and distance coordinates are rounded to this many meters
+	static const float Quantum;
+
+	///	an entry answers for origins this close to the one it was computed from
+	static const float OriginTolerance;
+
+	///	obstacles that moved less than this keep their shadow from the previous frame
+	static const float MoveThreshold;
+
+	static const int MaxEntries = 16;
+
+
+	class Entry {
+	public:
+		Entry() : view(Geometry2d::Point(), Geometry2d::Segment(Geometry2d::Point(), Geometry2d::Point()), -1) {
+			inUse = false;
+			count = 0;
+			timestamp = 0;
+		}
+
+		bool inUse;
+
+		//	key
+		int qTarget[4];
+		int qDist;
+		uint32_t excludeUs;
+		uint32_t excludeThem;
+
+		///	the geometry the windows were computed with
+		ShadowWindowEvaluator::View view;
+
+		ShadowWindowBuffer windows;
+
+		//	obstacles and their shadows.  ids are team * MaxRobots + index.
+		int ids[ShadowWindowEvaluator::MaxObstacles];
+		float x[ShadowWindowEvaluator::MaxObstacles];
+		float y[ShadowWindowEvaluator::MaxObstacles];
+		float start[ShadowWindowEvaluator::MaxObstacles];
+		float end[ShadowWindowEvaluator::MaxObstacles];
+		int count;
+
+		uint64_t timestamp;
+	};
+
+
+	///	Returns the windows for the given evaluation, computing or updating them if needed.
+	///	@maxDist < 0 means only obstacles in front of the target line cast shadows.
+	///	The entry may be overwritten by the next lookup, so copy what you need.
+	static const Entry &lookup(SystemState *state,
+							   const Geometry2d::Point &origin,
+							   const Geometry2d::Segment &target,
+							   float maxDist,
+							   const std::vector<Geometry2d::Point> &exclude);
+
+
+	///	shadows reused from the previous frame and shadows recomputed, since startup
+	static int reusedShadows() {
+		return _reused;
+	}
+
+	static int computedShadows() {
+		return _computed;
+	}
+
+	///	lookups since startup, and how many of them were answered from an entry's stored
+	///	shadows instead of computing every shadow again
+	static int lookups() {
+		return _lookups;
+	}
+
+	static int hits() {
+		return _hits;
+	}
+
+	static float hitRate() {
+		return _lookups > 0 ? (float)_hits / _lookups : 0;
+	}
+
+
+private:
+	static void update(Entry &entry, const WorldSnapshot &world);
+
+	static Entry _entries[MaxEntries];
+	static uint64_t _timestamp;
+
+	static int _reused;
+	static int _computed;
+	static int _lookups;
+	static int _hits;
+};
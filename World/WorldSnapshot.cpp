@@ -0,0 +1,111 @@
+
+#include "WorldSnapshot.hpp"
+
+#include <Constants.hpp>
+
+#include <cmath>
+#include <boost/foreach.hpp>
+
+using namespace Geometry2d;
+
+
+
+PerFrame<WorldSnapshot> WorldSnapshot::_current;
+
+
+
+//	copies one team's robots into the arrays of @team
+template<class RobotType, class RobotList>
+static void fillTeam(WorldSnapshot::Team &team, RobotType **robots, const RobotList &list) {
+	team.visible = 0;
+	team.count = 0;
+
+	BOOST_FOREACH(RobotType *r, list) {
+		//	SystemState never has this many, but don't overrun the arrays if it does
+		if ( team.count >= WorldSnapshot::MaxRobots ) break;
+
+		int i = team.count++;
+		robots[i] = r;
+
+		if ( r ) {
+			team.x[i] = r->pos.x;
+			team.y[i] = r->pos.y;
+			team.vx[i] = r->vel.x;
+			team.vy[i] = r->vel.y;
+			team.angle[i] = r->angle;
+			team.hx[i] = cos(r->angle * DegreesToRadians);
+			team.hy[i] = sin(r->angle * DegreesToRadians);
+
+			if ( r->visible ) team.visible |= 1u << i;
+		} else {
+			team.x[i] = team.y[i] = 0;
+			team.vx[i] = team.vy[i] = 0;
+			team.angle[i] = 0;
+			team.hx[i] = 1;
+			team.hy[i] = 0;
+		}
+	}
+
+	//	clear the unused slots so whole-array loops don't read garbage
+	for ( int i = team.count; i < WorldSnapshot::MaxRobots; i++ ) {
+		robots[i] = NULL;
+		team.x[i] = team.y[i] = 0;
+		team.vx[i] = team.vy[i] = 0;
+		team.angle[i] = 0;
+		team.hx[i] = 1;
+		team.hy[i] = 0;
+	}
+}
+
+
+
+WorldSnapshot::WorldSnapshot() {
+	timestamp = 0;
+	us.visible = them.visible = 0;
+	us.count = them.count = 0;
+
+	for ( int i = 0; i < MaxRobots; i++ ) {
+		_ourRobots[i] = NULL;
+		_opponents[i] = NULL;
+	}
+}
+
+
+
+const WorldSnapshot &WorldSnapshot::forState(SystemState *state) {
+	return _current.get(state, &WorldSnapshot::build);
+}
+
+
+
+void WorldSnapshot::build(SystemState *state) {
+	fillTeam(us, _ourRobots, state->self);
+	fillTeam(them, _opponents, state->opp);
+
+	ballPos = state->ball.pos;
+	ballVel = state->ball.vel;
+
+	timestamp = state->timestamp;
+}
+
+
+
+int WorldSnapshot::indexOf(const OurRobot *robot) const {
+	if ( !robot ) return -1;
+
+	for ( int i = 0; i < us.count; i++ ) {
+		if ( _ourRobots[i] == robot ) return i;
+	}
+
+	return -1;
+}
+
+int WorldSnapshot::indexOf(const OpponentRobot *robot) const {
+	if ( !robot ) return -1;
+
+	for ( int i = 0; i < them.count; i++ ) {
+		if ( _opponents[i] == robot ) return i;
+	}
+
+	return -1;
+}
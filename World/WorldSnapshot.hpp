@@ -0,0 +1,115 @@
+
+#pragma once
+
+#include "PerFrame.hpp"
+
+#include <framework/SystemState.hpp>
+
+#include <stdint.h>
+
+
+///	aligns SoA arrays to a cache line so they can be loaded with aligned SIMD instructions
+#define STP_CACHE_ALIGNED __attribute__((aligned(64)))
+
+
+/**
+ *	Immutable structure-of-arrays copy of the world, built once per tick.
+ *
+ *	SystemState stores robots as arrays of pointers to heap objects, so a loop over all
+ *	robots chases a pointer and checks @visible for each one.  The snapshot copies the
+ *	fields Actions actually read into flat, aligned arrays indexed the same way as
+ *	SystemState::self and SystemState::opp, so loops over a team touch contiguous memory
+ *	and can be vectorized by the compiler.
+ *
+ *	It lives alongside Action::self() and Action::opp() - use Action::world() in new code
+ *	and migrate existing code as it gets touched.
+ */
+class WorldSnapshot {
+public:
+
+	///	upper bound on the number of robots per team the snapshot holds
+	static const int MaxRobots = 16;
+
+
+	///	one team's robots, stored as parallel arrays
+	class Team {
+	public:
+		float x[MaxRobots] STP_CACHE_ALIGNED;
+		float y[MaxRobots] STP_CACHE_ALIGNED;
+		float vx[MaxRobots] STP_CACHE_ALIGNED;
+		float vy[MaxRobots] STP_CACHE_ALIGNED;
+
+		///	degrees, same as Robot::angle
+		float angle[MaxRobots] STP_CACHE_ALIGNED;
+
+		///	unit vector in the direction the robot is facing
+		float hx[MaxRobots] STP_CACHE_ALIGNED;
+		float hy[MaxRobots] STP_CACHE_ALIGNED;
+
+		///	bit i is set if robot i exists and is visible
+		uint32_t visible;
+
+		///	number of slots in the arrays that are filled in (visible or not)
+		int count;
+
+
+		bool isVisible(int i) const {
+			return (visible >> i) & 1;
+		}
+
+		Geometry2d::Point pos(int i) const {
+			return Geometry2d::Point(x[i], y[i]);
+		}
+
+		Geometry2d::Point vel(int i) const {
+			return Geometry2d::Point(vx[i], vy[i]);
+		}
+
+		Geometry2d::Point heading(int i) const {
+			return Geometry2d::Point(hx[i], hy[i]);
+		}
+	};
+
+
+	WorldSnapshot();
+
+
+	///	returns the snapshot for the current tick, building it if this is the first call of the tick
+	static const WorldSnapshot &forState(SystemState *state);
+
+
+	///	copies everything out of @state
+	void build(SystemState *state);
+
+
+	Team us;
+	Team them;
+
+	Geometry2d::Point ballPos;
+	Geometry2d::Point ballVel;
+
+	///	SystemState::timestamp of the tick this snapshot was built from
+	uint64_t timestamp;
+
+
+	///	the robot objects the arrays were filled from, for code that still needs them
+	OurRobot *ourRobot(int i) const {
+		return _ourRobots[i];
+	}
+
+	OpponentRobot *opponent(int i) const {
+		return _opponents[i];
+	}
+
+
+	///	index of the given robot in the arrays, or -1 if it isn't in the snapshot
+	int indexOf(const OurRobot *robot) const;
+	int indexOf(const OpponentRobot *robot) const;
+
+
+private:
+	OurRobot *_ourRobots[MaxRobots];
+	OpponentRobot *_opponents[MaxRobots];
+
+	static PerFrame<WorldSnapshot> _current;
+};
@@ -0,0 +1,114 @@
+#!/usr/bin/env python
+#
+#	Generates CompetitionConfig.hpp, which holds the configuration as compile-time constants for
+#	builds with STP_COMPETITION defined.
+#
+#	Every ConfigDouble and ConfigBool created in a createConfiguration() is found in the sources,
+#	starting from its default value.  If a tuned configuration file is given, its values replace
+#	the defaults.  That file is the XML written by Configuration, where a leaf element's path
+#	from the root is the config name, with '_' standing in for spaces.
+#
+#	Only groups that some source reads through CompetitionConfig::<Group>:: are written, so a
+#	class has to have a params() switch before its values are baked in.  The rest keep reading
+#	their ConfigDoubles in competition builds too.
+#
+#	usage: gen_competition_config.py [tuned_config.xml] > CompetitionConfig.hpp
+
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+
+CONFIG_RE = re.compile(r'new\s+Config(Double|Bool)\s*\(\s*cfg\s*,\s*"([^"]+)"\s*(?:,\s*([^;]+?))?\s*\)\s*;')
+USE_RE = re.compile(r'CompetitionConfig::(\w+)::')
+
+
+def identifier(name):
+	"""'Facing Thresh - Deg' -> 'FacingThreshDeg'"""
+	return ''.join(w[:1].upper() + w[1:] for w in re.split(r'[^A-Za-z0-9]+', name) if w)
+
+
+def find_defaults():
+	configs = {}
+	for dirpath, dirnames, filenames in os.walk(ROOT):
+		for f in sorted(filenames):
+			if not f.endswith('.cpp') or f.startswith('__TEMPLATE__'):
+				continue
+			with open(os.path.join(dirpath, f)) as src:
+				for kind, path, default in CONFIG_RE.findall(src.read()):
+					if kind == 'Bool':
+						default = default or 'false'
+					else:
+						default = default or '0'
+					configs[path] = (kind, default)
+	return configs
+
+
+def find_used_groups():
+	used = set()
+	for dirpath, dirnames, filenames in os.walk(ROOT):
+		for f in filenames:
+			if not f.endswith(('.cpp', '.hpp')) or f == 'CompetitionConfig.hpp':
+				continue
+			with open(os.path.join(dirpath, f)) as src:
+				used.update(USE_RE.findall(src.read()))
+	return used
+
+
+def read_tuned(filename):
+	values = {}
+
+	def walk(elem, path):
+		children = list(elem)
+		if not children:
+			text = (elem.text or '').strip()
+			if text:
+				values['/'.join(path).replace('_', ' ')] = text
+		for child in children:
+			walk(child, path + [child.tag])
+
+	walk(ET.parse(filename).getroot(), [])
+	return values
+
+
+def literal(kind, value):
+	if kind == 'Bool':
+		return 'true' if value.lower() in ('1', 'true') else 'false'
+	try:
+		return repr(float(value)) + 'f'
+	except ValueError:
+		#	defaults like "Ball_Radius * 2.0" are left to the compiler
+		return '(float)(%s)' % value
+
+
+def main():
+	configs = find_defaults()
+	tuned = read_tuned(sys.argv[1]) if len(sys.argv) > 1 else {}
+	used = find_used_groups()
+
+	groups = {}
+	for path, (kind, value) in configs.items():
+		group, _, name = path.partition('/')
+		if identifier(group) not in used:
+			continue
+		groups.setdefault(group, []).append((name, kind, tuned.get(path, value)))
+
+	out = sys.stdout
+	out.write('\n//\tGenerated by tools/gen_competition_config.py%s - do not edit.\n' %
+			(' from ' + os.path.basename(sys.argv[1]) if len(sys.argv) > 1 else ''))
+	out.write('\n#pragma once\n\n#include <Constants.hpp>\n\n\n')
+	out.write('namespace CompetitionConfig {\n')
+	for group in sorted(groups):
+		out.write('\n\tnamespace %s {\n' % identifier(group))
+		for name, kind, value in sorted(groups[group]):
+			ctype = 'bool' if kind == 'Bool' else 'float'
+			out.write('\t\tstatic const %s %s = %s;\n' % (ctype, identifier(name), literal(kind, value)))
+		out.write('\t}\n')
+	out.write('\n}\n')
+
+
+if __name__ == '__main__':
+	main()